@@ -40,42 +40,266 @@ mk_aircraft(uint32_t addr) {
 	return ret;
 }
 
+#define AC_TABLE_MINSIZE 256
+
+struct ms_ac_table_t *
+mk_ac_table() {
+	struct ms_ac_table_t *t;
+
+	t = calloc(1, sizeof(struct ms_ac_table_t));
+	t->size = AC_TABLE_MINSIZE;
+	t->slots = calloc(t->size, sizeof(struct ms_aircraft_t *));
+
+	return t;
+}
+
+/*
+ * Fibonacci hashing, as the low bits of
+ * addresses in a block are far from random.
+ */
+static size_t
+slot_of(const struct ms_ac_table_t *t, uint32_t addr) {
+	return ((uint32_t)(addr * 0x9E3779B1u) >> 8) & (t->size - 1);
+}
+
 struct ms_aircraft_t *
-find_aircraft(uint32_t addr, struct ms_aircraft_t *head) {
-	struct ms_aircraft_t *tmp;
+find_aircraft(uint32_t addr, const struct ms_ac_table_t *t) {
+	size_t i;
 
-	for (tmp = head; tmp; tmp = tmp->next) {
-		if (tmp->addr == addr) {
-			return tmp;
+	for (i = slot_of(t, addr); t->slots[i]; i = (i + 1) & (t->size - 1)) {
+		if (t->slots[i]->addr == addr) {
+			return t->slots[i];
 		}
 	}
 	return NULL;
 }
 
+static void
+insert_slot(struct ms_ac_table_t *t, struct ms_aircraft_t *a) {
+	size_t i;
+
+	for (i = slot_of(t, a->addr); t->slots[i]; i = (i + 1) & (t->size - 1))
+		;
+	t->slots[i] = a;
+}
+
+/*
+ * Empties the slot of a, and shifts back the aircrafts after
+ * it that would otherwise no longer be found, as probing for
+ * them stops at the first empty slot.
+ */
+static void
+remove_slot(struct ms_ac_table_t *t, const struct ms_aircraft_t *a) {
+	size_t mask = t->size - 1;
+	size_t i, j, k;
+
+	for (i = slot_of(t, a->addr); t->slots[i] != a; i = (i + 1) & mask)
+		;
+
+	for (j = i;;) {
+		t->slots[i] = NULL;
+		do {
+			j = (j + 1) & mask;
+			if (!t->slots[j])
+				return;
+			k = slot_of(t, t->slots[j]->addr);
+		} while (i <= j ? i < k && k <= j : i < k || k <= j);
+		t->slots[i] = t->slots[j];
+		i = j;
+	}
+}
+
+/*
+ * Adds a new aircraft with address addr, which
+ * mustn't already be in the table, first in line.
+ */
+struct ms_aircraft_t *
+add_aircraft(struct ms_ac_table_t *t, uint32_t addr) {
+	struct ms_aircraft_t *a;
+
+	if (2 * (t->n + 1) > t->size) {
+		struct ms_aircraft_t **slots;
+
+		if (!(slots = calloc(2 * t->size, sizeof(struct ms_aircraft_t *))))
+			return NULL;
+		free(t->slots);
+		t->slots = slots;
+		t->size *= 2;
+
+		for (a = t->head; a; a = a->next)
+			insert_slot(t, a);
+	}
+
+	a = mk_aircraft(addr);
+	a->altitudes.h.cap = t->history_cap;
+	a->squawks.h.cap = t->history_cap;
+	a->velocities.h.cap = t->history_cap;
+	a->locations.h.cap = t->history_cap;
+	a->next = t->head;
+	t->head = a;
+	insert_slot(t, a);
+	++t->n;
+
+	return a;
+}
+
+#define HISTORY_MINSIZE 16
+
+/*
+ * Returns the size h should grow to, if it's full and may
+ * grow, or else 0.
+ */
+static size_t
+history_grow(struct ms_ac_history_t *h) {
+	size_t size;
+
+	if (h->n < h->size || (h->cap && h->size >= h->cap))
+		return 0;
+
+	size = h->size ? 2 * h->size : HISTORY_MINSIZE;
+	if (h->cap && size > h->cap)
+		size = h->cap;
+
+	return size;
+}
+
+static void
+history_drop(struct ms_ac_history_t *h) {
+	h->start = (h->start + 1) % h->size;
+	if (--h->n)
+		h->first += h->dt[h->start];
+}
+
+/*
+ * Appends a sample at ts, dropping the oldest if h is capped
+ * and full, and returns the slot of its fields.
+ */
+static size_t
+history_push(struct ms_ac_history_t *h, time_t ts) {
+	size_t i;
+
+	if (h->n == h->size)
+		history_drop(h);
+
+	i = (h->start + h->n) % h->size;
+	if (h->n) {
+		h->dt[i] = ts - h->last;
+	} else {
+		h->dt[i] = 0;
+		h->first = ts;
+	}
+	h->last = ts;
+	++h->n;
+	++h->seq;
+
+	return i;
+}
+
+void
+history_begin(const struct ms_ac_history_t *h, struct ms_ac_cursor_t *c) {
+	c->i = 0;
+	c->slot = h->start;
+	c->time = h->first;
+}
+
+void
+history_next(const struct ms_ac_history_t *h, struct ms_ac_cursor_t *c) {
+	if (++c->i >= h->n)
+		return;
+	if (++c->slot == h->size)
+		c->slot = 0;
+	c->time += h->dt[c->slot];
+}
+
+/*
+ * Slot of the newest sample, h mustn't be empty.
+ */
+size_t
+history_last(const struct ms_ac_history_t *h) {
+	return (h->start + h->n - 1) % h->size;
+}
+
+/*
+ * Drops the samples from before ts, and returns the size h
+ * should shrink to, if a quarter of it or less is left,
+ * or else 0.
+ */
+static size_t
+history_trim(struct ms_ac_history_t *h, time_t ts) {
+	size_t size;
+
+	while (h->n && h->first < ts)
+		history_drop(h);
+
+	for (size = h->size; size > HISTORY_MINSIZE && 4 * h->n <= size; size /= 2)
+		;
+
+	return size < h->size ? size : 0;
+}
+
+/*
+ * Returns a new column of size samples, of width bytes
+ * each, with the samples of col, a column of h, moved
+ * to its start, or NULL, as realloc.
+ */
+static void *
+history_move(void *col, size_t width, const struct ms_ac_history_t *h, size_t size) {
+	char *ret;
+	size_t k;
+
+	if (!(ret = malloc(size * width)))
+		return NULL;
+
+	if (h->n) {
+		k = h->size - h->start;
+		if (k > h->n)
+			k = h->n;
+		memcpy(ret, (char *)col + h->start * width, k * width);
+		memcpy(ret + k * width, col, (h->n - k) * width);
+	}
+	free(col);
+
+	return ret;
+}
+
+/*
+ * Resizes h to size, once its other columns are moved.
+ */
+static void
+history_resize(struct ms_ac_history_t *h, size_t size) {
+	h->dt = history_move(h->dt, sizeof(int32_t), h, size);
+	h->start = 0;
+	h->size = size;
+}
+
+static void
+destroy_history(struct ms_ac_history_t *h) {
+	free(h->dt);
+}
+
 /*
  * TODO: keep track of different types
  * of position messages, by surface and Nb.
  */
 static void
 update_position(struct ms_aircraft_t *a, struct ms_CPR_t *CPR, time_t ts) {
-	struct ms_ac_location_t *loc = calloc(1, sizeof(struct ms_ac_location_t));
+	struct ms_ac_locations_t *l = &a->locations;
+	double lat, lon;
 	bool valid = false;
-	
-	loc->time = ts;
-	loc->next = NULL;
+	size_t i;
 
 	if (CPR->F) {
 		a->last_CPRs.odd_time = ts;
-		a->last_CPRs.odd = CPR;
+		a->last_CPRs.odd = *CPR;
 	} else {
 		a->last_CPRs.even_time = ts;
-		a->last_CPRs.even = CPR;
+		a->last_CPRs.even = *CPR;
 	}
 
-	if (a->last_CPRs.odd
-	 && a->last_CPRs.even
+	if (a->last_CPRs.odd_time
+	 && a->last_CPRs.even_time
 	 && labs(a->last_CPRs.odd_time - a->last_CPRs.even_time) <= 10) {
-		if (decode_cpr_global(a->last_CPRs.odd, a->last_CPRs.even, &loc->lat, &loc->lon, CPR->F) == 0)
+		if (decode_cpr_global(&a->last_CPRs.odd, &a->last_CPRs.even, &lat, &lon, CPR->F) == 0)
 		{
 			valid = true;
 		}
@@ -91,71 +315,63 @@ update_position(struct ms_aircraft_t *a, struct ms_CPR_t *CPR, time_t ts) {
 		}
 	}
 */
-	if (valid) {
-		if (a->locations.last) {
-			a->locations.last->next = loc;
-		} else {
-			a->locations.head = loc;
-		}
-		a->locations.last = loc;
-		a->locations.n++;
-		
-	} else {
-		free(loc);
-	}
+	if (!valid)
+		return;
 
+	if ((i = history_grow(&l->h))) {
+		l->lat = history_move(l->lat, sizeof(double), &l->h, i);
+		l->lon = history_move(l->lon, sizeof(double), &l->h, i);
+		history_resize(&l->h, i);
+	}
+	i = history_push(&l->h, ts);
+	l->lat[i] = lat;
+	l->lon[i] = lon;
 }
 
 static void
 update_velocity(struct ms_aircraft_t *a, const struct ms_velocity_t *v, time_t ts) {
-	struct ms_ac_velocity_t *vel = calloc(1, sizeof(struct ms_ac_velocity_t));
-
-	vel->speed = v->speed;
-	vel->heading = v->heading;
-	vel->vrate = v->vert;
-	vel->next = NULL;
-	vel->time = ts;
-	if (a->velocities.last)
-		a->velocities.last->next = vel;
-	else
-		a->velocities.head = vel;
-	a->velocities.last = vel;
-	a->velocities.n++;
+	struct ms_ac_velocities_t *vel = &a->velocities;
+	size_t i;
+
+	if ((i = history_grow(&vel->h))) {
+		vel->speed = history_move(vel->speed, sizeof(double), &vel->h, i);
+		vel->heading = history_move(vel->heading, sizeof(double), &vel->h, i);
+		vel->vrate = history_move(vel->vrate, sizeof(double), &vel->h, i);
+		history_resize(&vel->h, i);
+	}
+	i = history_push(&vel->h, ts);
+	vel->speed[i] = v->speed;
+	vel->heading[i] = v->heading;
+	vel->vrate[i] = v->vert;
 }
 
 static void
 update_altitude(struct ms_aircraft_t *a, const struct ms_AC_t *ac, time_t ts) {
-	struct ms_ac_altitude_t *alt;
+	struct ms_ac_altitudes_t *alt = &a->altitudes;
+	size_t i;
 	
 	if (ac->alt_ft < -50000) /* invalid or reserved */
 		return;
 
-	alt = calloc(1, sizeof(struct ms_ac_altitude_t));
-
-	alt->alt = ac->alt_ft;
-	alt->next = NULL;
-	alt->time = ts;
-	if (a->altitudes.last)
-		a->altitudes.last->next = alt;
-	else
-		a->altitudes.head = alt;
-	a->altitudes.last = alt;
-	a->altitudes.n++;
+	if ((i = history_grow(&alt->h))) {
+		alt->alt = history_move(alt->alt, sizeof(int32_t), &alt->h, i);
+		history_resize(&alt->h, i);
+	}
+	i = history_push(&alt->h, ts);
+	alt->alt[i] = ac->alt_ft;
 }
 
 static void
 update_squawk(struct ms_aircraft_t *a, uint16_t squawk, time_t ts) {
-	struct ms_ac_squawk_t *s = calloc(1, sizeof(struct ms_ac_squawk_t));
-
-	s->ID = squawk;
-	s->next = NULL;
-	s->time = ts;
-	if (a->squawks.last)
-		a->squawks.last->next = s;
-	else
-		a->squawks.head = s;
-	a->squawks.last = s;
-	a->squawks.n++;
+	struct ms_ac_squawks_t *s = &a->squawks;
+	size_t i;
+
+	if ((i = history_grow(&s->h))) {
+		s->ID = history_move(s->ID, sizeof(uint16_t), &s->h, i);
+		history_resize(&s->h, i);
+	}
+	i = history_push(&s->h, ts);
+	s->ID[i] = squawk;
 }
 
 static void
@@ -166,82 +382,108 @@ update_name(struct ms_aircraft_t *a, const struct ms_BDS_08_t *bds) {
 	a->name[8] = '\0';
 }
 
+static void
+add_msg(struct ms_aircraft_t *a, struct ms_msg_t *msg) {
+	if (msg->time > a->last_seen)
+		a->last_seen = msg->time;
+
+	msg->ac_next = NULL;
+
+	if (a->last_msg) {
+		a->last_msg->ac_next = msg;
+	} else {
+		a->messages = msg;
+	}
+	a->last_msg = msg;
+	msg->aircraft = a;
+
+	++a->n_msg_aux;
+	++a->n_messages;
+}
+
+/*
+ * Adds msg to the aircraft's messages, as update_aircraft, but
+ * leaves it undecoded unless it names the aircraft, for when
+ * the aircrafts are only counted and never tracked.
+ */
+void
+count_aircraft(struct ms_aircraft_t *a, struct ms_msg_t *msg) {
+	unsigned TC = msg->raw[4] >> 3;
+
+	if ((msg->DF == 17 || msg->DF == 18) && 1 <= TC && TC <= 4) {
+		const union ms_payload_t *p = decode_msg(msg);
+		const struct ms_aux_t *aux;
+
+		aux = msg->DF == 17 ? &p->DF17.aux : &p->DF18.aux;
+		if (aux->type == AUX_BDS_08)
+			update_name(a, &aux->u.BDS_08);
+	}
+
+	add_msg(a, msg);
+}
+
 void
 update_aircraft(struct ms_aircraft_t *a, struct ms_msg_t *msg) {
-	enum ms_extended_squitter_t es_t = ES_RESERVED;
-	const void *es_m = NULL;
+	struct ms_aux_t *aux = NULL;
 
 	struct ms_CPR_t *CPR = NULL;
 	const struct ms_velocity_t *vel = NULL;
 	const struct ms_AC_t *AC = NULL;
 	const uint16_t *ID = NULL;
 
-	if (msg->time > a->last_seen)
-		a->last_seen = msg->time;
+	union ms_payload_t *p = decode_msg(msg);
 
 	switch (msg->DF) {
-	case 17:{
-		struct ms_DF17_t *m = msg->msg;
-		es_m = m->aux;
-		es_t = m->ES_TYPE.et;
-		break;}
-	case 18:{
-		struct ms_DF18_t *m = msg->msg;
-
-		switch (m->CF) {
-		case 0: /* ADS-B */
-		case 1: /* ADS-B non-icao */
-		case 6: /* ADS-R */
-			es_m = m->aux;
-			es_t = m->ES_TYPE.et;
-			break;
-		case 2: /* TIS-B ‐ fine */
-			CPR = &((struct ms_TISB_fine_t *)m->aux)->CPR;
-			AC  = &((struct ms_TISB_fine_t *)m->aux)->AC;
-			break;
-		case 3: /* TIS-B - coarse */
-			CPR = &((struct ms_TISB_coarse_t *)m->aux)->CPR;
-			AC  = &((struct ms_TISB_coarse_t *)m->aux)->AC;
-			vel = &((struct ms_TISB_coarse_t *)m->aux)->velocity;
-			break;
-		}
-		break;}
+	case 17:
+		aux = &p->DF17.aux;
+		break;
+	case 18:
+		aux = &p->DF18.aux;
+		break;
 	case 4:
-		AC = &((struct ms_DF04_t *)msg->msg)->AC;
+		AC = &p->DF04.AC;
 		break;
 	case 5:
-		ID = &((struct ms_DF05_t *)msg->msg)->ID;
+		ID = &p->DF05.ID;
 		break;
 	case 16:
-		AC = &((struct ms_DF16_t *)msg->msg)->AC;
+		AC = &p->DF16.AC;
 		break;
 	case 20:
-		AC = &((struct ms_DF20_t *)msg->msg)->AC;
+		AC = &p->DF20.AC;
 		break;
 	case 21:
-		ID = &((struct ms_DF21_t *)msg->msg)->ID;
+		ID = &p->DF21.ID;
 		break;
-		
 	}
 
-	if (es_m) {
-		switch (es_t) {
-		case ES_IDENTIFICATION:
-			update_name(a, es_m);
+	if (aux) {
+		switch (aux->type) {
+		case AUX_BDS_08:
+			update_name(a, &aux->u.BDS_08);
+			break;
+		case AUX_BDS_05:
+			CPR = &aux->u.BDS_05.CPR;
+			AC  = &aux->u.BDS_05.AC;
+			break;
+		case AUX_BDS_06:
+			CPR = &aux->u.BDS_06.CPR;
+			vel = &aux->u.BDS_06.velocity;
 			break;
-		case ES_AIRBORNE_POSITION:
-			CPR = &((struct ms_BDS_05_t *)es_m)->CPR;
-			AC  = &((struct ms_BDS_05_t *)es_m)->AC;
+		case AUX_BDS_65:
+			a->NIC_s = aux->u.BDS_65.NIC_s;
 			break;
-		case ES_SURFACE_POSITION:
-			CPR = &((struct ms_BDS_06_t *)es_m)->CPR;
-			vel = &((struct ms_BDS_06_t *)es_m)->velocity;
+		case AUX_BDS_09:
+			vel = &aux->u.BDS_09.velocity;
 			break;
-		case ES_OPERATIONAL_STATUS:
-			a->NIC_s = ((struct ms_BDS_65_t *)es_m)->NIC_s;
+		case AUX_TISB_FINE:
+			CPR = &aux->u.TISB_fine.CPR;
+			AC  = &aux->u.TISB_fine.AC;
 			break;
-		case ES_AIRBORNE_VELOCITY:
-			vel = &((struct ms_BDS_09_t *)es_m)->velocity;
+		case AUX_TISB_COARSE:
+			CPR = &aux->u.TISB_coarse.CPR;
+			AC  = &aux->u.TISB_coarse.AC;
+			vel = &aux->u.TISB_coarse.velocity;
 			break;
 		default:
 			{}
@@ -260,21 +502,8 @@ update_aircraft(struct ms_aircraft_t *a, struct ms_msg_t *msg) {
 	if (ID) {
 		update_squawk(a, *ID, msg->time);
 	}
-	
-
-	msg->ac_next = NULL;
-
-	if (a->last_msg) {
-		a->last_msg->ac_next = msg;
-	} else {
-		a->messages = msg;
-	}
-	a->last_msg = msg;
-	msg->aircraft = a;
-
-	++a->n_msg_aux;
-	++a->n_messages;
 
+	add_msg(a, msg);
 }
 
 void
@@ -288,34 +517,155 @@ destroy_aircraft(struct ms_aircraft_t *a) {
 		a->messages = msg;
 	}
 
-	while (a->locations.head) {
-		struct ms_ac_location_t *loc;
-		loc = a->locations.head->next;
-		free(a->locations.head);
-		a->locations.head = loc;
-	}
+	destroy_history(&a->locations.h);
+	free(a->locations.lat);
+	free(a->locations.lon);
+
+	destroy_history(&a->altitudes.h);
+	free(a->altitudes.alt);
+
+	destroy_history(&a->squawks.h);
+	free(a->squawks.ID);
 
-	while (a->altitudes.head) {
-		struct ms_ac_altitude_t *alt;
-		alt = a->altitudes.head->next;
-		free(a->altitudes.head);
-		a->altitudes.head = alt;
+	destroy_history(&a->velocities.h);
+	free(a->velocities.speed);
+	free(a->velocities.heading);
+	free(a->velocities.vrate);
+
+	free(a);
+}
+
+/*
+ * Drops a's history and messages from before ts.
+ */
+static void
+trim_aircraft(struct ms_aircraft_t *a, time_t ts) {
+	struct ms_ac_locations_t *l = &a->locations;
+	struct ms_ac_altitudes_t *alt = &a->altitudes;
+	struct ms_ac_squawks_t *s = &a->squawks;
+	struct ms_ac_velocities_t *vel = &a->velocities;
+	size_t size;
+
+	if ((size = history_trim(&l->h, ts))) {
+		l->lat = history_move(l->lat, sizeof(double), &l->h, size);
+		l->lon = history_move(l->lon, sizeof(double), &l->h, size);
+		history_resize(&l->h, size);
+	}
+	if ((size = history_trim(&alt->h, ts))) {
+		alt->alt = history_move(alt->alt, sizeof(int32_t), &alt->h, size);
+		history_resize(&alt->h, size);
+	}
+	if ((size = history_trim(&s->h, ts))) {
+		s->ID = history_move(s->ID, sizeof(uint16_t), &s->h, size);
+		history_resize(&s->h, size);
+	}
+	if ((size = history_trim(&vel->h, ts))) {
+		vel->speed = history_move(vel->speed, sizeof(double), &vel->h, size);
+		vel->heading = history_move(vel->heading, sizeof(double), &vel->h, size);
+		vel->vrate = history_move(vel->vrate, sizeof(double), &vel->h, size);
+		history_resize(&vel->h, size);
 	}
 
-	while (a->squawks.head) {
-		struct ms_ac_squawk_t *id;
-		id = a->squawks.head->next;
-		free(a->squawks.head);
-		a->squawks.head = id;
+	while (a->messages && a->messages->time < ts)
+		destroy_msg(a->messages);
+}
+
+/*
+ * Bytes held by a, its history and messages, near enough.
+ * Messages kept past their batch are allocated one by one,
+ * see parse_chunk, and the rest are gone by the time the
+ * aircrafts are expired, see parse_stream, so none of them
+ * holds an arena.
+ */
+static size_t
+aircraft_mem(const struct ms_aircraft_t *a) {
+	return sizeof(struct ms_aircraft_t)
+	     + a->locations.h.size * (sizeof(int32_t) + 2 * sizeof(double))
+	     + a->altitudes.h.size * (sizeof(int32_t) + sizeof(int32_t))
+	     + a->squawks.h.size * (sizeof(int32_t) + sizeof(uint16_t))
+	     + a->velocities.h.size * (sizeof(int32_t) + 3 * sizeof(double))
+	     + a->n_msg_aux * sizeof(struct ms_msg_t);
+}
+
+/*
+ * Time of a's oldest sample or message, or ts if that's older.
+ */
+static time_t
+aircraft_oldest(const struct ms_aircraft_t *a, time_t ts) {
+	if (a->locations.h.n && a->locations.h.first < ts)
+		ts = a->locations.h.first;
+	if (a->altitudes.h.n && a->altitudes.h.first < ts)
+		ts = a->altitudes.h.first;
+	if (a->squawks.h.n && a->squawks.h.first < ts)
+		ts = a->squawks.h.first;
+	if (a->velocities.h.n && a->velocities.h.first < ts)
+		ts = a->velocities.h.first;
+	if (a->messages && a->messages->time < ts)
+		ts = a->messages->time;
+	return ts;
+}
+
+/*
+ * Retires the aircrafts not seen for t->ttl seconds, and if
+ * the rest take more than t->budget bytes, trims them all
+ * to a later time, a quarter of the way to the newest
+ * message at a time, until they don't, or only the
+ * newest second is left.
+ */
+void
+expire_aircrafts(struct ms_ac_table_t *t) {
+	struct ms_aircraft_t **p;
+	struct ms_aircraft_t *a;
+	size_t mem;
+	time_t oldest;
+
+	if (!t->ttl && !t->budget)
+		return;
+
+	mem = sizeof(struct ms_ac_table_t) + t->size * sizeof(struct ms_aircraft_t *);
+	t->mem = mem;
+	oldest = t->now;
+
+	for (p = &t->head; (a = *p);) {
+		if (t->ttl && t->now - a->last_seen > t->ttl) {
+			*p = a->next;
+			remove_slot(t, a);
+			--t->n;
+			if (t->retire)
+				t->retire(a, t->retire_arg);
+			destroy_aircraft(a);
+			continue;
+		}
+		t->mem += aircraft_mem(a);
+		oldest = aircraft_oldest(a, oldest);
+		p = &a->next;
 	}
 
-	while (a->velocities.head) {
-		struct ms_ac_velocity_t *vel;
-		vel = a->velocities.head->next;
-		free(a->velocities.head);
-		a->velocities.head = vel;
+	while (t->budget && t->mem > t->budget && oldest < t->now) {
+		time_t ts = oldest + (t->now - oldest + 3) / 4;
+
+		t->mem = mem;
+		oldest = t->now;
+		for (a = t->head; a; a = a->next) {
+			trim_aircraft(a, ts);
+			t->mem += aircraft_mem(a);
+			oldest = aircraft_oldest(a, oldest);
+		}
 	}
+}
 
+/*
+ * Destroys the table and all its aircrafts.
+ */
+void
+destroy_ac_table(struct ms_ac_table_t *t) {
+	while (t->head) {
+		struct ms_aircraft_t *tmp;
 
-	free(a);
+		tmp = t->head->next;
+		destroy_aircraft(t->head);
+		t->head = tmp;
+	}
+	free(t->slots);
+	free(t);
 }
@@ -20,31 +20,58 @@
 #include "message.h"
 #include "nation.h"
 
-struct ms_ac_velocity_t {
-	time_t time;
-	double speed;
-	double heading;
-	double vrate;
-	struct ms_ac_velocity_t *next;
+/*
+ * An aircraft's history of some property, oldest first, kept
+ * in columns, one per field, of a ring of size samples. Times
+ * are kept as seconds since the sample before, in dt, so that
+ * only first and last are known offhand. Grows as needed, or,
+ * if capped, until cap samples, after which the oldest sample
+ * is dropped for each new one. seq counts all samples ever.
+ */
+struct ms_ac_history_t {
+	int32_t *dt;
+	size_t start;
+	size_t n;
+	size_t size;
+	size_t cap;
+	size_t seq;
+	time_t first;
+	time_t last;
 };
 
-struct ms_ac_altitude_t {
+/*
+ * Position in a history, for iterating it oldest first:
+ *
+ *	for (history_begin(h, &c); c.i < h->n; history_next(h, &c))
+ *		... lat[c.slot] ... c.time ...
+ */
+struct ms_ac_cursor_t {
+	size_t i;
+	size_t slot;
 	time_t time;
-	double alt;
-	struct ms_ac_altitude_t *next;
 };
 
-struct ms_ac_squawk_t {
-	time_t time;
-	uint16_t ID;
-	struct ms_ac_squawk_t *next;
+struct ms_ac_locations_t {
+	struct ms_ac_history_t h;
+	double *lat;
+	double *lon;
 };
 
-struct ms_ac_location_t {
-	time_t time;
-	double lat;
-	double lon;
-	struct ms_ac_location_t *next;
+struct ms_ac_altitudes_t {
+	struct ms_ac_history_t h;
+	int32_t *alt;
+};
+
+struct ms_ac_squawks_t {
+	struct ms_ac_history_t h;
+	uint16_t *ID;
+};
+
+struct ms_ac_velocities_t {
+	struct ms_ac_history_t h;
+	double *speed;
+	double *heading;
+	double *vrate;
 };
 
 struct ms_aircraft_t {
@@ -66,43 +93,62 @@ struct ms_aircraft_t {
 	uint32_t n_messages;
 	uint32_t n_msg_aux;
 
+	/*
+	 * Copies, as the messages may be gone
+	 * before the other half of a pair arrives.
+	 */
 	struct {
 		time_t odd_time;
 		time_t even_time;
-		const struct ms_CPR_t *odd;
-		const struct ms_CPR_t *even;
+		struct ms_CPR_t odd;
+		struct ms_CPR_t even;
 	} last_CPRs;
 
-	struct {
-		struct ms_ac_altitude_t *head;
-		struct ms_ac_altitude_t *last;
-		size_t n;
-	} altitudes;
-
-	struct {
-		struct ms_ac_squawk_t *head;
-		struct ms_ac_squawk_t *last;
-		size_t n;
-	} squawks;
-
-	struct {
-		struct ms_ac_velocity_t *head;
-		struct ms_ac_velocity_t *last;
-		size_t n;
-	} velocities;
-
-	struct {
-		struct ms_ac_location_t *head;
-		struct ms_ac_location_t *last;
-		size_t n;
-	} locations;
+	struct ms_ac_altitudes_t altitudes;
+	struct ms_ac_squawks_t squawks;
+	struct ms_ac_velocities_t velocities;
+	struct ms_ac_locations_t locations;
 
 	struct ms_aircraft_t *next;
 	void *ext;
 };
 
+/*
+ * The aircrafts seen, newest first from head, and indexed by
+ * address in an open addressing table of size slots, which
+ * is grown to stay at most half full.
+ *
+ * Aircrafts not seen for ttl seconds, by the time of the
+ * newest message, are retired by expire_aircrafts, which
+ * then trims the history of the rest, oldest first, until
+ * they take at most budget bytes. retire, if set, gets to
+ * see each aircraft before it's destroyed.
+ */
+struct ms_ac_table_t {
+	struct ms_aircraft_t *head;
+	struct ms_aircraft_t **slots;
+	size_t size;
+	size_t n;
+	size_t history_cap; /* for new aircrafts, 0 for none */
+
+	time_t now;    /* of the newest message */
+	time_t ttl;    /* 0 for never */
+	size_t budget; /* 0 for no limit */
+	size_t mem;    /* in use, as of the last expire_aircrafts */
+	void (*retire)(struct ms_aircraft_t *, void *);
+	void *retire_arg;
+};
+
 struct ms_aircraft_t *mk_aircraft(uint32_t addr);
-struct ms_aircraft_t *find_aircraft(uint32_t addr, struct ms_aircraft_t *head);
+struct ms_ac_table_t *mk_ac_table();
+struct ms_aircraft_t *find_aircraft(uint32_t addr, const struct ms_ac_table_t *t);
+struct ms_aircraft_t *add_aircraft(struct ms_ac_table_t *t, uint32_t addr);
+void expire_aircrafts(struct ms_ac_table_t *t);
+void destroy_ac_table(struct ms_ac_table_t *t);
+void history_begin(const struct ms_ac_history_t *h, struct ms_ac_cursor_t *c);
+void history_next(const struct ms_ac_history_t *h, struct ms_ac_cursor_t *c);
+size_t history_last(const struct ms_ac_history_t *h);
 void update_aircraft(struct ms_aircraft_t *a, struct ms_msg_t *msg);
+void count_aircraft(struct ms_aircraft_t *a, struct ms_msg_t *msg);
 void destroy_aircraft(struct ms_aircraft_t *a);
 #endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "archive.h"
+#include "parse.h"
+#include "crc.h"
+#include "util.h"
+
+static void
+put32(uint8_t *p, uint32_t x) {
+	p[0] = x >>  0;
+	p[1] = x >>  8;
+	p[2] = x >> 16;
+	p[3] = x >> 24;
+}
+
+static uint32_t
+get32(const uint8_t *p) {
+	return ((uint32_t)p[0] <<  0)
+	     | ((uint32_t)p[1] <<  8)
+	     | ((uint32_t)p[2] << 16)
+	     | ((uint32_t)p[3] << 24);
+}
+
+void
+mk_archive_header(uint8_t *hdr) {
+	memcpy(hdr, ARCHIVE_MAGIC, 8);
+	put32(hdr +  8, ARCHIVE_VERSION);
+	put32(hdr + 12, ARCHIVE_RECLEN);
+}
+
+bool
+is_archive_header(const uint8_t *buf, size_t len) {
+	return len >= ARCHIVE_HDRLEN
+	    && !memcmp(buf, ARCHIVE_MAGIC, 8)
+	    && get32(buf +  8) == ARCHIVE_VERSION
+	    && get32(buf + 12) == ARCHIVE_RECLEN;
+}
+
+/*
+ * The syndrome is computed here, unless the frame
+ * already has it, so readers of the archive needn't.
+ */
+void
+frame_to_record(const struct ms_frame_t *frame, uint8_t *rec) {
+	uint64_t t = (int64_t)frame->time;
+	uint32_t syn = frame->syn;
+
+	if (syn & 0xFF000000)
+		syn = crc_syndrome(frame->raw, frame->len);
+
+	memset(rec, 0, ARCHIVE_RECLEN);
+	put32(rec + 0, t);
+	put32(rec + 4, t >> 32);
+	put32(rec + 8, frame->addr);
+	put32(rec + 12, syn);
+	rec[16] = frame->len;
+	rec[17] = frame->signal;
+	memcpy(rec + 18, frame->raw, frame->len);
+}
+
+/*
+ * Returns -1 for records whose length doesn't
+ * match their DF, e.g. in a damaged file.
+ */
+int
+record_to_frame(const uint8_t *rec, struct ms_frame_t *frame) {
+	uint64_t t = get32(rec) | (uint64_t)get32(rec + 4) << 32;
+
+	frame->time = (int64_t)t;
+	frame->mlat = 0;
+	frame->addr = get32(rec + 8);
+	frame->syn = get32(rec + 12);
+	frame->len = rec[16];
+	frame->signal = rec[17];
+
+	if ((frame->len != 7 && frame->len != 14)
+	 || df_to_len(rec[18] >> 3) != (ssize_t)frame->len)
+		return -1;
+
+	memcpy(frame->raw, rec + 18, frame->len);
+	return 0;
+}
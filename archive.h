@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_ARCHIVE_H
+#define _MS_ARCHIVE_H
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct ms_frame_t;
+
+/*
+ * Archive file layout, all integers little endian
+ *
+ *  header, ARCHIVE_HDRLEN bytes
+ *    0  magic, ARCHIVE_MAGIC
+ *    8  u32 version
+ *   12  u32 record length
+ *
+ *  followed by records, ARCHIVE_RECLEN bytes each
+ *    0  s64 time
+ *    8  u32 address, 0xFF000000 if not known
+ *   12  u32 syndrome
+ *   16  u8  message length, 7 or 14
+ *   17  u8  signal level
+ *   18  14 bytes of message, zero padded
+ */
+#define ARCHIVE_MAGIC    "\211MSARCH\n"
+#define ARCHIVE_VERSION  1
+#define ARCHIVE_HDRLEN   16
+#define ARCHIVE_RECLEN   32
+
+void mk_archive_header(uint8_t *hdr);
+bool is_archive_header(const uint8_t *buf, size_t len);
+void frame_to_record(const struct ms_frame_t *frame, uint8_t *rec);
+int  record_to_frame(const uint8_t *rec, struct ms_frame_t *frame);
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN    64 /* a cache line */
+#define ARENA_MINBLOCK (4 * 1024)
+#define ARENA_MAXBLOCK (1024 * 1024)
+
+struct ms_arena_block_t {
+	struct ms_arena_block_t *next;
+	size_t size;
+	size_t used;
+	/* Followed by size bytes */
+};
+
+#define BLOCK_HDRLEN ((sizeof(struct ms_arena_block_t) + ARENA_ALIGN - 1) \
+                      & ~(size_t)(ARENA_ALIGN - 1))
+
+struct ms_arena_t *
+mk_arena() {
+	struct ms_arena_t *arena;
+
+	arena = calloc(1, sizeof(struct ms_arena_t));
+	arena->refs = 1;
+
+	return arena;
+}
+
+/*
+ * Returns size zeroed bytes from the arena, aligned to a
+ * cache line, or from the heap if there's none, to be freed
+ * by free(). Blocks grow with the arena, so that small
+ * batches don't cost large blocks.
+ */
+void *
+arena_alloc(struct ms_arena_t *arena, size_t size) {
+	struct ms_arena_block_t *b;
+	void *p;
+
+	if (!arena) {
+		if (posix_memalign(&p, ARENA_ALIGN, size))
+			return NULL;
+		return memset(p, 0, size);
+	}
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	b = arena->blocks;
+
+	if (!b || b->size - b->used < size) {
+		size_t bsize = b ? 2 * b->size : ARENA_MINBLOCK;
+
+		if (bsize > ARENA_MAXBLOCK)
+			bsize = ARENA_MAXBLOCK;
+		if (bsize < size)
+			bsize = size;
+
+		if (posix_memalign(&p, ARENA_ALIGN, BLOCK_HDRLEN + bsize))
+			return NULL;
+		b = p;
+		b->size = bsize;
+		b->used = 0;
+		b->next = arena->blocks;
+		arena->blocks = b;
+	}
+
+	p = (char *)b + BLOCK_HDRLEN + b->used;
+	b->used += size;
+	memset(p, 0, size);
+
+	return p;
+}
+
+struct ms_arena_t *
+hold_arena(struct ms_arena_t *arena) {
+	++arena->refs;
+	return arena;
+}
+
+void
+release_arena(struct ms_arena_t *arena) {
+	if (--arena->refs)
+		return;
+
+	while (arena->blocks) {
+		struct ms_arena_block_t *b = arena->blocks->next;
+		free(arena->blocks);
+		arena->blocks = b;
+	}
+	free(arena);
+}
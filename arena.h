@@ -0,0 +1,41 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_ARENA_H
+#define _MS_ARENA_H
+
+#include <sys/types.h>
+
+struct ms_arena_block_t;
+
+/*
+ * Messages and their payloads are carved out of an arena,
+ * a list of blocks, instead of being allocated one by one.
+ * Each message holds a reference to its arena, as does its
+ * maker while parsing, and the arena is freed as a whole
+ * when the last of them is released.
+ */
+struct ms_arena_t {
+	struct ms_arena_block_t *blocks;
+	size_t refs;
+};
+
+struct ms_arena_t *mk_arena();
+void *arena_alloc(struct ms_arena_t *arena, size_t size);
+struct ms_arena_t *hold_arena(struct ms_arena_t *arena);
+void release_arena(struct ms_arena_t *arena);
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_AUX_H
+#define _MS_AUX_H
+
+#include "bds_05.h"
+#include "bds_06.h"
+#include "bds_08.h"
+#include "bds_09.h"
+#include "bds_30.h"
+#include "bds_61.h"
+#include "bds_62.h"
+#include "bds_65.h"
+#include "bds_f2.h"
+#include "tisb_c.h"
+#include "tisb_f.h"
+
+enum ms_aux_type_t {
+	AUX_NONE,
+	AUX_BDS_05,
+	AUX_BDS_06,
+	AUX_BDS_08,
+	AUX_BDS_09,
+	AUX_BDS_30,
+	AUX_BDS_61_1,
+	AUX_BDS_62,
+	AUX_BDS_65,
+	AUX_BDS_F2,
+	AUX_TISB_FINE,
+	AUX_TISB_COARSE
+};
+
+/*
+ * The decoded contents of a message's ME, MB, MV or MD
+ * field, kept inline in its DF specific part. type tells
+ * which member of u is valid, if any.
+ */
+struct ms_aux_t {
+	enum ms_aux_type_t type;
+	union {
+		struct ms_BDS_05_t BDS_05;
+		struct ms_BDS_06_t BDS_06;
+		struct ms_BDS_08_t BDS_08;
+		struct ms_BDS_09_t BDS_09;
+		struct ms_BDS_30_t BDS_30;
+		struct ms_BDS_61_1_t BDS_61_1;
+		struct ms_BDS_62_t BDS_62;
+		struct ms_BDS_65_t BDS_65;
+		struct ms_BDS_F2_t BDS_F2;
+		struct ms_TISB_fine_t TISB_fine;
+		struct ms_TISB_coarse_t TISB_coarse;
+	} u;
+};
+
+#endif
@@ -33,12 +33,8 @@
  *  0       1       2       3       4       5       6       
  *
  */
-struct ms_BDS_05_t *
-mk_BDS_05(const uint8_t *msg) {
-	struct ms_BDS_05_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_BDS_05_t));
-
+void
+mk_BDS_05(struct ms_BDS_05_t *ret, const uint8_t *msg) {
 	ret->FTC = msg[0] >> 3;
 	ret->SS  = msg[0] & 0x06;
 	ret->SAF = msg[0] & 0x01;
@@ -56,7 +52,6 @@ mk_BDS_05(const uint8_t *msg) {
 	ret->AC.M = false;
 
 	ret->alt_type = ret->FTC < 19 ? ALT_BAROMETRIC : ALT_GNSS;
-	return ret;
 }
 
 /*
@@ -39,6 +39,6 @@ struct ms_BDS_05_t {
 	enum ms_ALT_TYPE_t alt_type;
 };
 
-struct ms_BDS_05_t *mk_BDS_05(const uint8_t *msg);
+void mk_BDS_05(struct ms_BDS_05_t *ret, const uint8_t *msg);
 void pr_BDS_05(FILE *fp, const struct ms_BDS_05_t *p, int v);
 #endif
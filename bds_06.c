@@ -58,12 +58,8 @@ decode_angle(uint8_t v) {
  *  0       1       2       3       4       5       6       
  *
  */
-struct ms_BDS_06_t *
-mk_BDS_06(const uint8_t *msg) {
-	struct ms_BDS_06_t *ret;
-	
-	ret = calloc(1, sizeof(struct ms_BDS_06_t));
-	
+void
+mk_BDS_06(struct ms_BDS_06_t *ret, const uint8_t *msg) {
 	ret->FTC = msg[0] >> 4;
 	ret->UTC_SYNCED_TIME = msg[2] & 0x08;
 
@@ -85,7 +81,6 @@ mk_BDS_06(const uint8_t *msg) {
 	ret->CPR.lat = ((msg[2] & 0x03) << 15) | (msg[3] << 7) | (msg[4] >> 1);
 	ret->CPR.lon = ((msg[4] & 0x01) << 16) | (msg[5] << 8) | (msg[6] >> 0);
 	
-	return ret;
 }
 
 static void
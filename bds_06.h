@@ -27,7 +27,7 @@ struct ms_BDS_06_t {
 	struct ms_CPR_t CPR;
 };
 
-struct ms_BDS_06_t *mk_BDS_06(const uint8_t *msg);
+void mk_BDS_06(struct ms_BDS_06_t *ret, const uint8_t *msg);
 void pr_BDS_06(FILE *fp, const struct ms_BDS_06_t *pp, int v);
 
 #endif
@@ -42,14 +42,11 @@ static const char ICAO_CHARSET[] =
 	"89______";
 
 
-struct ms_BDS_08_t *
-mk_BDS_08(const uint8_t *msg) {
-	struct ms_BDS_08_t *ret;
+void
+mk_BDS_08(struct ms_BDS_08_t *ret, const uint8_t *msg) {
 	uint8_t chars[8];
 	int i;
 
-	ret = calloc(1, sizeof(struct ms_BDS_08_t));
-
 	ret->FTC = msg[0] >> 3;
 	ret->category = msg[0] & 0x07;
 
@@ -69,8 +66,6 @@ mk_BDS_08(const uint8_t *msg) {
 			break;
 		ret->name[i] = '\0';
 	}
-
-	return ret;
 }
 
 static void
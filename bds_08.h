@@ -26,7 +26,7 @@ struct ms_BDS_08_t {
 };
 
 void pr_BDS_08(FILE *fp, const struct ms_BDS_08_t*p, int v);
-struct ms_BDS_08_t *mk_BDS_08(const uint8_t *msg);
+void mk_BDS_08(struct ms_BDS_08_t *ret, const uint8_t *msg);
 void pr_category(FILE *fp, uint8_t, uint8_t);
 
 #endif
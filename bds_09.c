@@ -27,13 +27,10 @@
  * [3] B.2.3.5
  * [3] Tables B-2-9a, B-2-9b
  */
-struct ms_BDS_09_t *
-mk_BDS_09(const uint8_t *msg) {
-	struct ms_BDS_09_t *ret;
+void
+mk_BDS_09(struct ms_BDS_09_t *ret, const uint8_t *msg) {
 	double ew, ns;
 
-	ret = calloc(1, sizeof(struct ms_BDS_09_t));
-
 	ret->FTC = msg[0] >> 3;
 	ret->subtype = msg[0] & 0x07;
 
@@ -86,7 +83,6 @@ mk_BDS_09(const uint8_t *msg) {
 	}
 	if (ret->velocity.heading <= 0.0)
 		ret->velocity.heading += 360.0;
-	return ret;
 }
 
 void
@@ -65,6 +65,6 @@ struct ms_BDS_09_t {
 
 };
 
-struct ms_BDS_09_t *mk_BDS_09(const uint8_t *msg);
+void mk_BDS_09(struct ms_BDS_09_t *ret, const uint8_t *msg);
 void pr_BDS_09(FILE *fp, const struct ms_BDS_09_t *p, int v);
 #endif
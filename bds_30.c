@@ -39,12 +39,8 @@
  *                                2109876543210
  *
  */
-struct ms_BDS_30_t *
-mk_BDS_30(const uint8_t *m) {
-	struct ms_BDS_30_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_BDS_30_t));
-
+void
+mk_BDS_30(struct ms_BDS_30_t *ret, const uint8_t *m) {
 	ret->ara41 = m[1] & 0x80;
 	ret->ara42 = m[1] & 0x40;
 	ret->ara43 = m[1] & 0x20;
@@ -83,8 +79,6 @@ mk_BDS_30(const uint8_t *m) {
 
 		ret->TIDB = m[6] & 0x3F;
 	}
-
-	return ret;
 }
 
 /*
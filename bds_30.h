@@ -51,7 +51,7 @@ struct ms_BDS_30_t {
 
 };
 
-struct ms_BDS_30_t *mk_BDS_30(const uint8_t *msg);
+void mk_BDS_30(struct ms_BDS_30_t *ret, const uint8_t *msg);
 
 void pr_BDS_30(FILE *fp, const struct ms_BDS_30_t *p, int v);
 void pr_ACAS_RA(FILE *fp, const struct ms_BDS_30_t *p, int v);
@@ -26,15 +26,9 @@
  * [3] Table B-2-97a
  * (BDS 61:2 is handled as BDS 30)
  */
-struct ms_BDS_61_1_t *
-mk_BDS_61_1(const uint8_t *msg) {
-	struct ms_BDS_61_1_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_BDS_61_1_t));
-
+void
+mk_BDS_61_1(struct ms_BDS_61_1_t *ret, const uint8_t *msg) {
 	ret->emergency_state = msg[1] >> 5;
-
-	return ret;
 }
 
 void
@@ -37,7 +37,7 @@ struct ms_BDS_61_1_t {
 #define ms_BDS_61_2_t ms_BDS_30_t
 #define mk_BDS_61_2   mk_BDS_30
 
-struct ms_BDS_61_1_t *mk_BDS_61_1(const uint8_t *msg);
+void mk_BDS_61_1(struct ms_BDS_61_1_t *ret, const uint8_t *msg);
 
 void pr_BDS_61_1(FILE *fp, const struct ms_BDS_61_1_t *pp, int v);
 void pr_BDS_61_2(FILE *fp, const struct ms_BDS_61_2_t *pp, int v);
@@ -27,12 +27,8 @@
  *
  *
  */
-struct ms_BDS_62_t *
-mk_BDS_62(const uint8_t *msg) {
-	struct ms_BDS_62_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_BDS_62_t));
-
+void
+mk_BDS_62(struct ms_BDS_62_t *ret, const uint8_t *msg) {
 	ret->FTC = msg[0] >> 3;
 	ret->subtype = (msg[0] >> 1) & 0x03;
 
@@ -62,8 +58,6 @@ mk_BDS_62(const uint8_t *msg) {
 
 	ret->CMC = (msg[6] >> 2) & 0x03;
 	ret->EMERG = (msg[6] & 0x07);
-
-	return ret;
 }
 
 /*
@@ -79,6 +79,6 @@ struct ms_BDS_62_t {
 	uint8_t EMERG;
 };
 
-struct ms_BDS_62_t *mk_BDS_62(const uint8_t *msg);
+void mk_BDS_62(struct ms_BDS_62_t *ret, const uint8_t *msg);
 void pr_BDS_62(FILE *fp, const struct ms_BDS_62_t *p, int v);
 #endif
@@ -64,11 +64,8 @@ fill_OM(const uint8_t *raw, struct ms_OM_t *OM) {
  *  0       1       2       3       4       5       6       
  *
  */
-struct ms_BDS_65_t *
-mk_BDS_65(const uint8_t *msg) {
-	struct ms_BDS_65_t *ret;
-	ret = calloc(1, sizeof(struct ms_BDS_65_t));
-
+void
+mk_BDS_65(struct ms_BDS_65_t *ret, const uint8_t *msg) {
 	ret->FTC = msg[0] >> 3;
 	ret->subtype = msg[0] & 0x07;
 
@@ -273,8 +270,6 @@ mk_BDS_65(const uint8_t *msg) {
 	 * ME-bits 51-52
 	 */
 	ret->SIL = (msg[6] >> 4) & 0x03;
-
-	return ret;
 }
 
 
@@ -104,6 +104,6 @@ struct ms_BDS_65_t {
 	uint8_t SIL;
 };
 
-struct ms_BDS_65_t *mk_BDS_65(const uint8_t *msg);
+void mk_BDS_65(struct ms_BDS_65_t *ret, const uint8_t *msg);
 void pr_BDS_65(FILE *fp, const struct ms_BDS_65_t *p, int v);
 #endif
@@ -23,17 +23,13 @@
 #include "mac.h"
 #include "fields.h"
 
-struct ms_BDS_F2_t *
-mk_BDS_F2(const uint8_t *msg) {
-	struct ms_BDS_F2_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_BDS_F2_t));
-
+void
+mk_BDS_F2(struct ms_BDS_F2_t *ret, const uint8_t *msg) {
 	ret->TYPE = msg[0] >> 3;
 
 	if (ret->TYPE != 1) {
 		/* Unassigned */
-		return ret;
+		return;
 	}
 
 	ret->M1CF = msg[0] & 0x02;
@@ -56,8 +52,6 @@ mk_BDS_F2(const uint8_t *msg) {
 	ret->modes[2].val = decode_ID(ret->modes[2].raw);
 
 	ret->reserved = msg[6];
-
-	return ret;
 }
 
 void
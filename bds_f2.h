@@ -31,7 +31,7 @@ struct ms_BDS_F2_t {
 };
 
 void pr_BDS_F2(FILE *fp, const struct ms_BDS_F2_t*p, int v);
-struct ms_BDS_F2_t *mk_BDS_F2(const uint8_t *msg);
+void mk_BDS_F2(struct ms_BDS_F2_t *ret, const uint8_t *msg);
 
 #endif
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "beast.h"
+#include "parse.h"
+#include "util.h"
+
+/*
+ * Beast binary format, as output by Mode-S Beast receivers and dump1090
+ *
+ *  <1A> <type> <6 byte MLAT timestamp> <signal level> <payload>
+ *
+ *  type '1' Mode A/C, 2 byte payload
+ *  type '2' Mode S short, 7 byte payload
+ *  type '3' Mode S long, 14 byte payload
+ *
+ * The timestamp is a big endian 48 bit 12 MHz counter. Any 1A in the
+ * frame, after the type, is escaped by doubling it.
+ */
+
+/*
+ * Returns the number of bytes consumed from buf, or 0 if it
+ * doesn't hold a complete frame yet. frame->len is set to 0
+ * for frames that aren't Mode S messages and for garbage
+ * skipped while looking for the start of the next frame.
+ */
+ssize_t
+beast_to_frame(const uint8_t *buf, size_t len, struct ms_frame_t *frame) {
+	uint8_t data[7 + 14];
+	size_t need;
+	size_t i, n;
+
+	frame->len = 0;
+
+	if (len < 2)
+		return 0;
+
+	if (buf[0] != BEAST_ESC) {
+		const uint8_t *p = memchr(buf, BEAST_ESC, len);
+		return p ? p - buf : (ssize_t)len;
+	}
+
+	switch (buf[1]) {
+	case '1':
+		need = 2;
+		break;
+	case '2':
+		need = 7;
+		break;
+	case '3':
+		need = 14;
+		break;
+	default:
+		/* Status frames, or not in sync */
+		return 1;
+	}
+
+	for (i = 2, n = 0; n < 7 + need; ++n) {
+		if (i >= len)
+			return 0;
+		if (buf[i] == BEAST_ESC) {
+			if (i + 1 >= len)
+				return 0;
+			if (buf[i + 1] != BEAST_ESC)
+				/* Truncated, next frame starts here */
+				return i;
+			++i;
+		}
+		data[n] = buf[i++];
+	}
+
+	frame->mlat = ((uint64_t)data[0] << 40)
+	            | ((uint64_t)data[1] << 32)
+	            | ((uint64_t)data[2] << 24)
+	            | ((uint64_t)data[3] << 16)
+	            | ((uint64_t)data[4] <<  8)
+	            | ((uint64_t)data[5] <<  0);
+	frame->signal = data[6];
+	frame->time = 0;
+	frame->addr = 0xFF000000;
+	frame->syn = 0xFF000000;
+
+	if (need != 2 && df_to_len(data[7] >> 3) == (ssize_t)need) {
+		memcpy(frame->raw, data + 7, need);
+		frame->len = need;
+	}
+
+	return i;
+}
@@ -0,0 +1,12 @@
+#ifndef _MS_BEAST_H
+#define _MS_BEAST_H
+
+#include <sys/types.h>
+#include <stdint.h>
+
+struct ms_frame_t;
+
+#define BEAST_ESC 0x1A
+
+ssize_t beast_to_frame(const uint8_t *buf, size_t len, struct ms_frame_t *frame);
+#endif
@@ -0,0 +1,444 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "cpr.c"
+
+/*
+ * Decoding is checked against reference decoders that follow
+ * [3] as written, in floating point, with the rules cpr.c adds:
+ * latitudes from 270 are taken 360 down, those outside +-90
+ * are refused, and longitudes are given in [-180, 180).
+ */
+static unsigned long n_checked;
+static unsigned long n_ties;
+
+/*
+ * NL, [3] Table C-4, a comparison at a time
+ */
+static uint8_t
+ref_NL(double lat) {
+	int k;
+
+	if (lat < 0)
+		lat = -lat;
+	for (k = 0; k < 58; ++k)
+		if (lat < NL_lat[k])
+			return 59 - k;
+	return 1;
+}
+
+/*
+ * MOD, [3] A.2.6.2 e)
+ */
+static double
+ref_mod(double x, double y) {
+	return x - y * floor(x / y);
+}
+
+static double
+ref_lon(double lon) {
+	if (lon >= 180.0)
+		lon -= 360.0;
+	else if (lon < -180.0)
+		lon += 360.0;
+	return lon;
+}
+
+/*
+ * [3] A.2.6.7
+ */
+static int
+ref_global(const struct ms_CPR_t *odd, const struct ms_CPR_t *even,
+           double *ret_lat, double *ret_lon, bool i) {
+	double span = odd->surface ? 90.0 : 360.0;
+	double N = pow(2, odd->Nb);
+	double Dlat0, Dlat1, Dlon, Rlat0, Rlat1, j, m;
+	int nl0, nl1, nl, ni;
+
+	if (odd->Nb != even->Nb || odd->surface != even->surface)
+		return -1;
+
+	Dlat0 = span / (4 * 15 - 0);
+	Dlat1 = span / (4 * 15 - 1);
+	j = floor(0.5 + (59.0 * even->lat - 60.0 * odd->lat) / N);
+	Rlat0 = Dlat0 * (even->lat / N + ref_mod(j, 60));
+	Rlat1 = Dlat1 * (odd->lat / N + ref_mod(j, 59));
+	if (Rlat0 >= 270.0)
+		Rlat0 -= 360.0;
+	if (Rlat1 >= 270.0)
+		Rlat1 -= 360.0;
+	if (Rlat0 < -90.0 || Rlat0 > 90.0 || Rlat1 < -90.0 || Rlat1 > 90.0)
+		return -1;
+	if ((nl0 = ref_NL(Rlat0)) != (nl1 = ref_NL(Rlat1)))
+		return -1;
+
+	nl = i ? nl1 : nl0;
+	ni = nl - i < 1 ? 1 : nl - i;
+	Dlon = span / ni;
+	m = floor(0.5 + ((double)even->lon * (nl - 1) - (double)odd->lon * nl) / N);
+
+	*ret_lat = i ? Rlat1 : Rlat0;
+	*ret_lon = ref_lon(Dlon * ((i ? odd->lon : even->lon) / N + ref_mod(m, ni)));
+	return 0;
+}
+
+/*
+ * [3] A.2.6.5. The arguments of the floors, of which the
+ * zone indices are found, are left in xj and xm.
+ */
+static int
+ref_local(const struct ms_CPR_t *cpr, double lat_s, double lon_s,
+          double *ret_lat, double *ret_lon, bool i, double *xj, double *xm) {
+	double span = cpr->surface ? 90.0 : 360.0;
+	double N = pow(2, cpr->Nb);
+	double Dlat, Dlon, Rlat, j, m;
+	int nl;
+
+	*xj = *xm = 0.5;
+	if (!(lat_s >= -90.0 && lat_s <= 90.0 && lon_s >= -360.0 && lon_s <= 360.0))
+		return -1;
+
+	Dlat = span / (4 * 15 - i);
+	*xj = 0.5 + ref_mod(lat_s, Dlat) / Dlat - cpr->lat / N;
+	j = floor(lat_s / Dlat) + floor(*xj);
+	Rlat = Dlat * (j + cpr->lat / N);
+	if (Rlat >= 270.0)
+		Rlat -= 360.0;
+	if (Rlat < -90.0 || Rlat > 90.0)
+		return -1;
+
+	nl = ref_NL(Rlat);
+	Dlon = nl == i ? span : span / (nl - i);
+	*xm = 0.5 + ref_mod(lon_s, Dlon) / Dlon - cpr->lon / N;
+	m = floor(lon_s / Dlon) + floor(*xm);
+
+	*ret_lat = Rlat;
+	*ret_lon = ref_lon(Dlon * (m + cpr->lon / N));
+	return 0;
+}
+
+static bool
+same(int r1, double a1, double o1, int r2, double a2, double o2) {
+	return r1 == r2 && (r1 || (!memcmp(&a1, &a2, sizeof(double))
+	                        && !memcmp(&o1, &o2, sizeof(double))));
+}
+
+static int
+check_global(const struct ms_CPR_t *odd, const struct ms_CPR_t *even, bool i) {
+	double a1 = 0, o1 = 0, a2 = 0, o2 = 0;
+	int r1, r2;
+
+	r1 = decode_cpr_global(odd, even, &a1, &o1, i);
+	r2 = ref_global(odd, even, &a2, &o2, i);
+	++n_checked;
+
+	if (!same(r1, a1, o1, r2, a2, o2)) {
+		fprintf(stderr, "chkcpr: ERROR: global, Nb %d%s, i %d, "
+		        "YZ %u %u, XZ %u %u: %d %.17g %.17g, not %d %.17g %.17g\n",
+		        odd->Nb, odd->surface ? " surface" : "", i,
+		        even->lat, odd->lat, even->lon, odd->lon,
+		        r1, a1, o1, r2, a2, o2);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Zone indices may only differ from the reference's where
+ * the argument of its floor is as near an integer as its
+ * own rounding, where neither can be told right.
+ */
+static bool
+tie(double x) {
+	return fabs(x - floor(x + 0.5)) < 1e-9;
+}
+
+static int
+check_local(const struct ms_CPR_t *cpr, double lat_s, double lon_s, bool i) {
+	double a1 = 0, o1 = 0, a2 = 0, o2 = 0;
+	double xj, xm;
+	int r1, r2;
+
+	r1 = decode_cpr_local(cpr, lat_s, lon_s, &a1, &o1, i);
+	r2 = ref_local(cpr, lat_s, lon_s, &a2, &o2, i, &xj, &xm);
+	++n_checked;
+
+	if (!same(r1, a1, o1, r2, a2, o2)) {
+		if (tie(xj) || (tie(xm) && !memcmp(&a1, &a2, sizeof(double)))) {
+			++n_ties;
+			return 0;
+		}
+		fprintf(stderr, "chkcpr: ERROR: local, Nb %d%s, i %d, "
+		        "YZ %u, XZ %u, near %.17g %.17g: %d %.17g %.17g, "
+		        "not %d %.17g %.17g\n",
+		        cpr->Nb, cpr->surface ? " surface" : "", i,
+		        cpr->lat, cpr->lon, lat_s, lon_s,
+		        r1, a1, o1, r2, a2, o2);
+		return -1;
+	}
+
+	return 0;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t
+rnd(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/*
+ * Encodes lat and lon, [3] A.2.6.3, to find
+ * the inputs of a position in some NL zone.
+ */
+static void
+encode(double lat, double lon, bool i, struct ms_CPR_t *cpr) {
+	double N = pow(2, cpr->Nb);
+	double Dlat = 360.0 / (60 - i);
+	double Dlon, Rlat;
+	int nl;
+
+	cpr->lat = (uint32_t)floor(N * ref_mod(lat, Dlat) / Dlat + 0.5) & ((1 << cpr->Nb) - 1);
+	Rlat = Dlat * (cpr->lat / N + floor(lat / Dlat));
+	nl = ref_NL(Rlat) - i < 1 ? 1 : ref_NL(Rlat) - i;
+	Dlon = 360.0 / nl;
+	cpr->lon = (uint32_t)floor(N * ref_mod(lon, Dlon) / Dlon + 0.5) & ((1 << cpr->Nb) - 1);
+}
+
+/*
+ * NL about each latitude it changes at, to the last bit,
+ * and every 1/4096 of a degree, north and south.
+ */
+static int
+check_NL(void) {
+	double lat;
+	int k, n, s;
+
+	for (k = 0; k < 58; ++k) {
+		for (s = -1; s <= 1; s += 2) {
+			lat = s * NL_lat[k];
+			for (n = 0; n < 1000; ++n)
+				lat = nextafter(lat, -1000.0);
+			for (n = 0; n <= 2000; ++n, lat = nextafter(lat, 1000.0)) {
+				if (NL(lat) != ref_NL(lat))
+					goto bad;
+			}
+		}
+	}
+	for (lat = -91.0; lat <= 91.0; lat += 1.0 / 4096) {
+		if (NL(lat) != ref_NL(lat))
+			goto bad;
+	}
+	return 0;
+bad:
+	fprintf(stderr, "chkcpr: ERROR: NL(%.17g) is %d, not %d\n",
+	        lat, NL(lat), ref_NL(lat));
+	return -1;
+}
+
+/*
+ * Every 17 bit latitude of each kind, with others that put
+ * 59 YZ0 - 60 YZ1 on either side of where j changes, in each
+ * of a few zones, and every 17 bit longitude of each kind,
+ * in every NL zone, with one that puts m on either side of a
+ * change, and one at random. Then surface positions, and
+ * 12 bit ones, at random.
+ */
+static int
+check_globals(void) {
+	const int32_t N = 1 << 17, half = 1 << 16;
+	struct ms_CPR_t cpr[2];
+	int32_t a, v, r;
+	int nl, i, k;
+
+	memset(cpr, 0, sizeof(cpr));
+	cpr[0].Nb = cpr[1].Nb = 17;
+	cpr[1].F = 1;
+
+	for (i = 0; i < 2; ++i) {
+		for (a = 0; a < N; ++a) {
+			for (k = 0; k < 8; ++k) {
+				cpr[i].lat = a;
+				r = (a * 7 + k * 13) % (i ? 59 : 60);
+				if (i) {
+					/* YZ0 from 60 YZ1 - half + multiples of N */
+					v = 60 * a - half;
+					v = v - floor_shr(v, 17) * N + r * N;
+					cpr[0].lat = v / 59 + (k & 1);
+				} else {
+					v = 59 * a + half;
+					v = v - floor_shr(v, 17) * N + r * N;
+					cpr[1].lat = v / 60 + (k & 1);
+				}
+				cpr[!i].lat &= N - 1;
+				cpr[0].lon = rnd() & (N - 1);
+				cpr[1].lon = rnd() & (N - 1);
+				if (check_global(&cpr[1], &cpr[0], k & 2) < 0)
+					return -1;
+			}
+		}
+	}
+
+	for (nl = 59; nl >= 1; --nl) {
+		double lo = nl == 59 ? 0 : NL_lat[58 - nl];
+		double hi = nl == 1 ? 90.0 : NL_lat[59 - nl];
+		double lat = (lo + hi) / 2 * (nl & 1 ? -1 : 1);
+
+		encode(lat, 10.0, 0, &cpr[0]);
+		encode(lat, 10.0, 1, &cpr[1]);
+
+		for (i = 0; i < 2; ++i) {
+			int nli = NL(lat);
+
+			for (a = 0; a < N; ++a) {
+				for (k = 0; k < 2; ++k) {
+					cpr[i].lon = a;
+					cpr[!i].lon = rnd() & (N - 1);
+					if (k == 0 && !i) {
+						/* XZ0 (nl - 1) - XZ1 nl + half, by multiples of N */
+						v = a * (nli - 1) + half;
+						v = v - floor_shr(v, 17) * N + (rnd() % nli) * N;
+						cpr[1].lon = (v / nli + (a & 1)) & (N - 1);
+					} else if (k == 0 && nli > 1) {
+						v = a * nli - half;
+						v = v - floor_shr(v, 17) * N + (rnd() % (nli - 1)) * N;
+						cpr[0].lon = (v / (nli - 1) + (a & 1)) & (N - 1);
+					}
+					if (check_global(&cpr[1], &cpr[0], i) < 0)
+						return -1;
+				}
+			}
+		}
+	}
+
+	for (k = 0; k < (1 << 22); ++k) {
+		cpr[0].Nb = cpr[1].Nb = k & 1 ? 12 : 17;
+		cpr[0].surface = cpr[1].surface = (k >> 1) & 1;
+		cpr[0].lat = rnd() & ((1 << cpr[0].Nb) - 1);
+		cpr[1].lat = rnd() & ((1 << cpr[0].Nb) - 1);
+		cpr[0].lon = rnd() & ((1 << cpr[0].Nb) - 1);
+		cpr[1].lon = rnd() & ((1 << cpr[0].Nb) - 1);
+		if (check_global(&cpr[1], &cpr[0], (k >> 2) & 1) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/*
+ * Every 17 bit latitude and longitude, of each kind, on the
+ * surface and not, near references across the globe, with
+ * some on the antimeridian and the poles.
+ */
+static int
+check_locals(void) {
+	static const double lons[8] = {
+		-180.0, -179.99, -90.5, 0.0, 0.001, 45.3, 179.999, 359.9
+	};
+	const uint32_t N = 1 << 17;
+	struct ms_CPR_t cpr;
+	uint32_t a;
+	int k, i;
+
+	memset(&cpr, 0, sizeof(cpr));
+	cpr.Nb = 17;
+
+	for (k = 0; k <= 32; ++k) {
+		double lat_s = -90.0 + k * 180.0 / 32;
+		double lon_s = lons[k % 8];
+
+		for (i = 0; i < 4; ++i) {
+			cpr.F = i & 1;
+			cpr.surface = i >> 1;
+			for (a = 0; a < N; ++a) {
+				cpr.lat = a;
+				cpr.lon = (a * 40503 + k) & (N - 1);
+				if (check_local(&cpr, lat_s, lon_s, cpr.F) < 0)
+					return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Every pair of 17 bit latitudes, which takes hours.
+ */
+static int
+check_lat_pairs(void) {
+	const uint32_t N = 1 << 17;
+	struct ms_CPR_t odd, even;
+	uint32_t a, b;
+
+	memset(&odd, 0, sizeof(odd));
+	memset(&even, 0, sizeof(even));
+	odd.Nb = even.Nb = 17;
+	odd.F = 1;
+
+	for (a = 0; a < N; ++a) {
+		for (b = 0; b < N; ++b) {
+			even.lat = a;
+			odd.lat = b;
+			even.lon = (a * 2654435761u) >> 15;
+			odd.lon = (b * 40503 + a) & (N - 1);
+			if (check_global(&odd, &even, (a ^ b) & 1) < 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Checks NL against [3] Table C-4, and decoding against
+ * [3] as written, see ref_global and ref_local. With -v,
+ * it tells how many positions were checked. With -a, it
+ * also checks every pair of 17 bit latitudes, which takes
+ * about an hour and a half.
+ */
+int
+main(int argc, char *argv[]) {
+	bool verbose = false;
+	bool all = false;
+	int k;
+
+	for (k = 1; k < argc; ++k) {
+		if (!strcmp(argv[k], "-v")) {
+			verbose = true;
+		} else if (!strcmp(argv[k], "-a")) {
+			all = true;
+		} else {
+			fprintf(stderr, "usage: chkcpr [-v] [-a]\n");
+			return 1;
+		}
+	}
+
+	if (check_NL() < 0
+	 || check_globals() < 0
+	 || check_locals() < 0
+	 || (all && check_lat_pairs() < 0))
+		return 1;
+
+	if (verbose)
+		fprintf(stderr, "chkcpr: %lu positions checked, %lu at ties\n",
+		        n_checked, n_ties);
+	return 0;
+}
@@ -21,6 +21,29 @@ static const uint32_t squawk_ttl = 600;
 static const char default_histogram_filename[]  = "/tmp/msdec-hist-XXXXXX";
 static const char default_statistics_filename[] = "/tmp/msdec-stats-XXXXXX";
 static const char default_aircraft_directory[]  = "/tmp/msdec-blackbox-XXXXXX";
+/*
+ * Number of threads to parse files with,
+ * 0 = one per online processor
+ */
+static const int default_threads = 1;
+/*
+ * Decode input in batches of this many KiB, keeping
+ * only the aircrafts' derived history between them.
+ * 0 = everything at once
+ */
+static const size_t default_batch = 0;
+/*
+ * Aircrafts not seen for this many seconds are retired,
+ * after their logs are dumped, if they are to be
+ * 0 = never
+ */
+static const int default_aircraft_ttl = 0;
+/*
+ * Aircrafts' history is trimmed, oldest first, to keep
+ * them within this many MiB
+ * 0 = no limit
+ */
+static const size_t default_memory_budget = 0;
 #endif
 
 
@@ -60,6 +83,23 @@ static const int default_seen_list = 60 * 60;
  * seconds, 0 = less than one second ago
  */
 static const int default_seen_active = 60 * 2;
+/*
+ * Most positions, altitudes, velocities and squawks kept
+ * per aircraft, the oldest are dropped first
+ * 0 = no limit
+ */
+static const size_t default_history_cap = 0;
+/*
+ * Aircrafts not seen for this many seconds are retired
+ * 0 = never
+ */
+static const int default_aircraft_ttl = 0;
+/*
+ * Aircrafts' history and messages are trimmed, oldest
+ * first, to keep them within this many MiB
+ * 0 = no limit
+ */
+static const size_t default_memory_budget = 0;
 /*
  * Plot listed aircrafts, even if they are not active
  */
@@ -94,6 +134,13 @@ static gid_t default_daemon_gid = 87;
  */
 static gid_t default_log_gid = 10;
 static gid_t default_out_gid = 10;
+/*
+ * Most bits in error to correct in messages with parity
+ * overlaid with the address, valid values [0, 2]. DF11
+ * with an interrogator identifier only gets one corrected,
+ * as two would turn about 1.2% of garbage into messages.
+ */
+static int default_nfix_crc = 1;
 #endif
 
 
@@ -24,9 +24,17 @@
 /*
  * Compact position reporting
  * [3] A.2.6
+ *
+ * Zone indices are found in integers, exactly as the floor of
+ * the quotients in [3], once a local reference is taken to
+ * units of the encoding, and only the decoded positions are
+ * computed in floating point, by the same expressions as there.
+ * See chkcpr, run by make check, which checks them against [3]
+ * to the bit.
  */
 static uint8_t NL(double);
 static int32_t mod(int32_t, int32_t);
+static int32_t floor_shr(int32_t, unsigned);
 static const uint8_t NZ = 15;
 
 /*
@@ -41,11 +49,24 @@ decode_cpr_local(const struct ms_CPR_t *cpr,
 {
 	double Dlat, Dlon;
 	double Rlat, Rlon;
-	int j, m;
-	uint32_t YZ, XZ;
+	double scale;
+	int32_t j, m;
+	int32_t half;
+	int nl;
+	int32_t YZ, XZ;
+
+	/*
+	 * A reference out of range is refused, as it
+	 * would be out of floor_shr's range too.
+	 */
+	if (!(lat_s >= -90.0 && lat_s <= 90.0
+	   && lon_s >= -360.0 && lon_s <= 360.0))
+		return -1;
 
 	YZ = cpr->lat;
 	XZ = cpr->lon;
+	scale = 1.0 / ((uint32_t)1 << cpr->Nb);
+	half = (int32_t)1 << (cpr->Nb - 1);
 
 
 	/*
@@ -54,15 +75,19 @@ decode_cpr_local(const struct ms_CPR_t *cpr,
 	Dlat = (cpr->surface ? 90.0 : 360.0)  / (4 * NZ - i);
 
 	/*
-	 * b) j: Latitude zone index
+	 * b) j: Latitude zone index,
+	 *    floor(lat_s / Dlat)
+	 *    + floor(1/2 + MOD(lat_s, Dlat) / Dlat - YZ / 2^Nb),
+	 *    that is floor(1/2 + (y - YZ) / 2^Nb), where y is the
+	 *    reference in units of 2^-Nb zones, which may be
+	 *    taken to the integer below without changing it
 	 */
-	j = floor(lat_s / Dlat)
-	  + floor( (mod(lat_s, Dlat) / Dlat) - (YZ / pow(2, cpr->Nb)) + 0.5 );
+	j = floor_shr((int32_t)floor(lat_s / Dlat / scale) - YZ + half, cpr->Nb);
 
 	/*
 	 * c) Rlat: Decoded position latitude
 	 */
-	Rlat = Dlat * (j + YZ / pow(2, cpr->Nb));
+	Rlat = Dlat * (j + YZ * scale);
 	if (Rlat >= 270.0)
 		Rlat -= 360.0;
 	
@@ -72,23 +97,25 @@ decode_cpr_local(const struct ms_CPR_t *cpr,
 	/*
 	 * d) Dlon: Longitude zone size
 	 */
-	if (NL(Rlat) == i)
+	if ((nl = NL(Rlat)) == i)
 		Dlon = (cpr->surface ? 90.0 : 360.0);
 	else
-		Dlon = (cpr->surface ? 90.0 : 360.0) / (NL(Rlat) - i);
+		Dlon = (cpr->surface ? 90.0 : 360.0) / (nl - i);
 
 	/*
-	 * e) m: Longitude zone index 
+	 * e) m: Longitude zone index, as j
 	 */
-	m = floor(lon_s / Dlon)
-	  + floor( (mod(lon_s, Dlon) / Dlon) - (XZ / pow(2, cpr->Nb)) + 0.5);
+	m = floor_shr((int32_t)floor(lon_s / Dlon / scale) - XZ + half, cpr->Nb);
 
 	/*
-	 * f) Rlon: Decoded position longitude
+	 * f) Rlon: Decoded position longitude, east or west,
+	 *    as near the reference as it may be
 	 */
-	Rlon = Dlon * (m + XZ / pow(2, cpr->Nb));
-	if (Rlon >= 270.0)
+	Rlon = Dlon * (m + XZ * scale);
+	if (Rlon >= 180.0)
 		Rlon -= 360.0;
+	else if (Rlon < -180.0)
+		Rlon += 360.0;
 	
 	/* Make caller happy */
 	*ret_lat = Rlat;
@@ -110,11 +137,13 @@ decode_cpr_global(const struct ms_CPR_t *odd,
 {
 	double Dlat0, Dlat1, Dlon;
 	double Rlat0, Rlat1, Rlon;
-	int j, m;
+	double scale;
+	int32_t j, m;
+	int32_t half;
 	int nl0, nl1, nli, ni;
 	uint32_t XZi, Nb;
-	uint32_t YZ0, XZ0;
-	uint32_t YZ1, XZ1;
+	int32_t YZ0, XZ0;
+	int32_t YZ1, XZ1;
 
 	
 	if (odd->Nb != even->Nb
@@ -124,6 +153,8 @@ decode_cpr_global(const struct ms_CPR_t *odd,
 	}
 
 	Nb = odd->Nb;
+	scale = 1.0 / ((uint32_t)1 << Nb);
+	half = (int32_t)1 << (Nb - 1);
 
 	YZ0 = even->lat;
 	XZ0 = even->lon;
@@ -137,20 +168,25 @@ decode_cpr_global(const struct ms_CPR_t *odd,
 	Dlat1 = (odd->surface ? 90.0 : 360.0) / (4 * NZ - 1);
 	
 	/*
-	 * b) Latitude index
+	 * b) Latitude index,
+	 *    floor(1/2 + (59 YZ0 - 60 YZ1) / 2^Nb)
 	 */
-	j = floor(0.5 + (59 * YZ0 - 60 * YZ1) / pow(2.0, Nb));
+	j = floor_shr(59 * YZ0 - 60 * YZ1 + half, Nb);
 
 	/*
 	 * c) Decoded latitude
 	 */
-	Rlat0 = Dlat0 * (YZ0 / pow(2.0, Nb) + mod(j, 60));
-	Rlat1 = Dlat1 * (YZ1 / pow(2.0, Nb) + mod(j, 59));
+	Rlat0 = Dlat0 * (YZ0 * scale + mod(j, 60));
+	Rlat1 = Dlat1 * (YZ1 * scale + mod(j, 59));
 
 	if (Rlat0 >= 270.0)
 		Rlat0 -= 360.0;
 	if (Rlat1 >= 270.0)
-		Rlat0 -= 360.0;
+		Rlat1 -= 360.0;
+
+	if (Rlat0 < -90.0 || Rlat0 > +90.0
+	 || Rlat1 < -90.0 || Rlat1 > +90.0)
+		return -1;
 	
 	/*
 	 * d) Messages must be from same zone
@@ -175,14 +211,17 @@ decode_cpr_global(const struct ms_CPR_t *odd,
 	Dlon = (odd->surface ? 90.0 : 360.0) / (ni);
 
 	/*
-	 * f) Longitude index.
+	 * f) Longitude index,
+	 *    floor(1/2 + (XZ0 (NL - 1) - XZ1 NL) / 2^Nb)
 	 */
-	m = floor( 0.5  +  (XZ0 * (nli - 1)  -  XZ1 * nli) / pow(2, Nb) );
+	m = floor_shr(XZ0 * (nli - 1) - XZ1 * nli + half, Nb);
 
 	/*
-	 * g) Global decoded longitude.
+	 * g) Global decoded longitude, east or west.
 	 */
-	Rlon = Dlon * ( XZi / pow(2, Nb)  +  mod(m, ni));
+	Rlon = Dlon * (XZi * scale + mod(m, ni));
+	if (Rlon >= 180.0)
+		Rlon -= 360.0;
 
 	/*
 	 * h) Reasonableness test… TODO :(
@@ -194,83 +233,78 @@ decode_cpr_global(const struct ms_CPR_t *odd,
 	
 }
 
+/*
+ * MOD, [3] A.2.6.2 e), of integers,
+ * in [0, divisor) for positive divisors.
+ */
 static int32_t
 mod(int32_t dividend, int32_t divisor) {
 	int32_t rem = dividend % divisor;
 
-	if (rem > 0)
+	if (rem >= 0)
 		return rem;
 	else
 		return rem + divisor;
 }
 
+/*
+ * floor(x / 2^n), for |x| < 2^26 and n at most 26. Biased
+ * to be positive, so as not to depend on how negative
+ * numbers are shifted.
+ */
+static int32_t
+floor_shr(int32_t x, unsigned n) {
+	return (int32_t)((uint32_t)(x + ((int32_t)1 << 26)) >> n)
+	     - ((int32_t)1 << (26 - n));
+}
+
 /*
  * NL-function
  * [3] A.2.6.2 f)
  * [3] Table C-4
+ *
+ * Latitudes at which NL drops by one, from 59 to 1.
+ */
+static const double NL_lat[58] = {
+	10.4704713, 14.8281744, 18.1862636, 21.0293949, 23.5450449,
+	25.8292471, 27.9389871, 29.9113569, 31.7720971, 33.5399344,
+	35.2289960, 36.8502511, 38.4124189, 39.9225668, 41.3865183,
+	42.8091401, 44.1945495, 45.5462672, 46.8673325, 48.1603913,
+	49.4277644, 50.6715017, 51.8934247, 53.0951615, 54.2781747,
+	55.4437844, 56.5931876, 57.7274735, 58.8476378, 59.9545928,
+	61.0491777, 62.1321666, 63.2042748, 64.2661652, 65.3184531,
+	66.3617101, 67.3964677, 68.4232202, 69.4424263, 70.4545107,
+	71.4598647, 72.4588454, 73.4517744, 74.4389342, 75.4205626,
+	76.3968439, 77.3678946, 78.3337408, 79.2942823, 80.2492321,
+	81.1980135, 82.1395698, 83.0719944, 83.9917356, 84.8916619,
+	85.7554162, 86.5353700, 87.0000000
+};
+
+/*
+ * Number of entries in NL_lat below each whole degree. No
+ * degree holds more than two, so NL is found with two
+ * comparisons, whatever the latitude.
+ */
+#ifdef MK_CPR_TBL
+/*
+ * Filled in by mkcpr, to generate cpr_tbl.h.
  */
+static uint8_t NL_deg[87];
+#else
+#include "cpr_tbl.h"
+#endif
+
 static uint8_t
 NL(double lat) {
+	const double *t;
+	int k;
+
 	if (lat < 0)
 		lat = -lat;
+	if (!(lat < 87.0))
+		return 1;
 
-	if (lat < 10.4704713) return 59;
-	if (lat < 14.8281744) return 58;
-	if (lat < 18.1862636) return 57;
-	if (lat < 21.0293949) return 56;
-	if (lat < 23.5450449) return 55;
-	if (lat < 25.8292471) return 54;
-	if (lat < 27.9389871) return 53;
-	if (lat < 29.9113569) return 52;
-	if (lat < 31.7720971) return 51;
-	if (lat < 33.5399344) return 50;
-	if (lat < 35.2289960) return 49;
-	if (lat < 36.8502511) return 48;
-	if (lat < 38.4124189) return 47;
-	if (lat < 39.9225668) return 46;
-	if (lat < 41.3865183) return 45;
-	if (lat < 42.8091401) return 44;
-	if (lat < 44.1945495) return 43;
-	if (lat < 45.5462672) return 42;
-	if (lat < 46.8673325) return 41;
-	if (lat < 48.1603913) return 40;
-	if (lat < 49.4277644) return 39;
-	if (lat < 50.6715017) return 38;
-	if (lat < 51.8934247) return 37;
-	if (lat < 53.0951615) return 36;
-	if (lat < 54.2781747) return 35;
-	if (lat < 55.4437844) return 34;
-	if (lat < 56.5931876) return 33;
-	if (lat < 57.7274735) return 32;
-	if (lat < 58.8476378) return 31;
-	if (lat < 59.9545928) return 30;
-	if (lat < 61.0491777) return 29;
-	if (lat < 62.1321666) return 28;
-	if (lat < 63.2042748) return 27;
-	if (lat < 64.2661652) return 26;
-	if (lat < 65.3184531) return 25;
-	if (lat < 66.3617101) return 24;
-	if (lat < 67.3964677) return 23;
-	if (lat < 68.4232202) return 22;
-	if (lat < 69.4424263) return 21;
-	if (lat < 70.4545107) return 20;
-	if (lat < 71.4598647) return 19;
-	if (lat < 72.4588454) return 18;
-	if (lat < 73.4517744) return 17;
-	if (lat < 74.4389342) return 16;
-	if (lat < 75.4205626) return 15;
-	if (lat < 76.3968439) return 14;
-	if (lat < 77.3678946) return 13;
-	if (lat < 78.3337408) return 12;
-	if (lat < 79.2942823) return 11;
-	if (lat < 80.2492321) return 10;
-	if (lat < 81.1980135) return 9;
-	if (lat < 82.1395698) return 8;
-	if (lat < 83.0719944) return 7;
-	if (lat < 83.9917356) return 6;
-	if (lat < 84.8916619) return 5;
-	if (lat < 85.7554162) return 4;
-	if (lat < 86.5353700) return 3;
-	if (lat < 87.0000000) return 2;
-	return 1;
+	k = NL_deg[(int)lat];
+	t = NL_lat + k;
+	return 59 - k - (lat >= t[0]) - (lat >= t[1]);
 }
@@ -15,12 +15,56 @@
  */
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "crc.h"
+
+/*
+ * Carry-less multiplication is no faster than the tables for
+ * messages this short, unless they're out of cache, so it's
+ * only used if asked for, by building with -DCRC_CLMUL.
+ */
+#if defined(CRC_CLMUL) && !((defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__))
+#undef CRC_CLMUL
+#endif
+#ifdef CRC_CLMUL
+#include <immintrin.h>
+#endif
 
 /*
  * Message parity, AP and PI fields
  * [1] 3.1.2.3.3
+ *
+ * The parity is the remainder of the data, times x^24, divided
+ * by the generator polynomial, 0x1FFF409. It's found either a
+ * slice of four or eight bytes at a time, in crc_slices, where
+ * crc_slices[k][b] is the remainder of byte b followed by k zero
+ * bytes, or by carry-less multiplication, where the processor
+ * has it, as a Barrett reduction with crc_mu, the low 64 bits
+ * of x^88 divided by the polynomial.
+ */
+#define CRC_POLY 0xFFF409
+
+/*
+ * Bits in error, of up to two, are looked up by syndrome in
+ * open addressing tables of 2^n slots, one for each length,
+ * and one for short messages whose low seven bits of parity
+ * are overlaid with an interrogator identifier, as DF11. Each
+ * slot holds a pattern of bits, as FIX_BIT(i) | FIX_BIT2(j),
+ * from the first bit of the message, and its key is the
+ * syndrome of the pattern, by crc_syn_short or crc_syn_long.
+ * Only the fewest bits that give a syndrome are kept, and a
+ * syndrome given by more than one pattern of as few bits, or
+ * by one touching the DF field, is rejected.
  */
+#define FIX_SHORT_BITS 12
+#define FIX_LONG_BITS  14
+#define FIX_BIT(i)     ((i) + 1)
+#define FIX_BIT2(j)    (((j) + 1) << 7)
+#define FIX_REJECT     0x8000
+#define FIX_DF_BITS    5
 
+#ifdef MK_CRC_TBL
 /*
  * Table generated by:
  * 
@@ -29,6 +73,7 @@
  *		 --xor-out=0x0 --reflect-out=0 \
  *		 --poly=0x1205FFF
  *
+ * Only used by mkcrc, to generate crc_tbl.h.
  */
 static const uint32_t crc_table[] = {
 	0x000000, 0xfff409, 0x001c1b, 0xffe812, 0x003836, 0xffcc3f, 0x00242d, 0xffd024,
@@ -65,22 +110,161 @@ static const uint32_t crc_table[] = {
 	0x05d4a4, 0xfa20ad, 0x05c8bf, 0xfa3cb6, 0x05ec92, 0xfa189b, 0x05f089, 0xfa0480
 };
 
-uint32_t
-checksum(const uint8_t *msg, size_t len) {
+static uint32_t crc_slices[8][256];
+static uint64_t crc_mu;
+static uint32_t crc_syn_short[56];
+static uint32_t crc_syn_long[112];
+static uint16_t crc_fix_short[1 << FIX_SHORT_BITS];
+static uint16_t crc_fix_iid[1 << FIX_SHORT_BITS];
+static uint16_t crc_fix_long[1 << FIX_LONG_BITS];
+
+/*
+ * Reference, a byte at a time, of n bytes of data.
+ */
+static uint32_t
+crc_bytes(const uint8_t *msg, size_t n) {
 	uint32_t crc = 0x00000000;
 	uint8_t tmp;
 	size_t i;
 
-	if (len != 7 && len != 14)
-		return 0x0F000000;
-
-	for (i = 0; i < len - 3; ++i) {
+	for (i = 0; i < n; ++i) {
 		tmp = msg[i] ^ (crc >> 16);
 		crc = crc_table[tmp] ^ (crc << 8);
 	}
 
 	return crc & 0x00FFFFFF;
 }
+#else
+#include "crc_tbl.h"
+#endif
+
+/*
+ * The data of short messages, four bytes, as one slice, and of
+ * long messages, eleven bytes, as a slice of eight, and one of
+ * three with the remainder so far added to it. These are macros
+ * so that crc_syndromes can interleave them.
+ */
+#define CRC56_SLICE(msg) \
+	(crc_slices[3][(msg)[0]] ^ crc_slices[2][(msg)[1]] \
+	^ crc_slices[1][(msg)[2]] ^ crc_slices[0][(msg)[3]])
+
+#define CRC112_HEAD(msg) \
+	(crc_slices[7][(msg)[0]] ^ crc_slices[6][(msg)[1]] \
+	^ crc_slices[5][(msg)[2]] ^ crc_slices[4][(msg)[3]] \
+	^ crc_slices[3][(msg)[4]] ^ crc_slices[2][(msg)[5]] \
+	^ crc_slices[1][(msg)[6]] ^ crc_slices[0][(msg)[7]])
+
+#define CRC112_TAIL(msg, crc) \
+	(crc_slices[2][(msg)[8] ^ ((crc) >> 16)] \
+	^ crc_slices[1][(msg)[9] ^ (((crc) >> 8) & 0xFF)] \
+	^ crc_slices[0][(msg)[10] ^ ((crc) & 0xFF)])
+
+static uint32_t
+crc56_sliced(const uint8_t *msg) {
+	return CRC56_SLICE(msg);
+}
+
+static uint32_t
+crc112_sliced(const uint8_t *msg) {
+	uint32_t crc = CRC112_HEAD(msg);
+
+	return CRC112_TAIL(msg, crc);
+}
+
+#ifdef CRC_CLMUL
+/*
+ * Remainder of h times x^24. The quotient is h plus the high
+ * half of h times crc_mu, and the remainder the low 24 bits
+ * of the quotient times the polynomial, less its x^24 term.
+ */
+__attribute__((target("pclmul")))
+static uint32_t
+crc_clmul(uint64_t h) {
+	__m128i v, q;
+
+	v = _mm_set_epi64x(crc_mu, h);
+	q = _mm_clmulepi64_si128(v, v, 0x10);
+	q = _mm_xor_si128(_mm_srli_si128(q, 8), v);
+	q = _mm_clmulepi64_si128(q, _mm_cvtsi32_si128(CRC_POLY), 0x00);
+
+	return _mm_cvtsi128_si32(q) & 0x00FFFFFF;
+}
+
+static uint32_t
+crc56_clmul(const uint8_t *msg) {
+	uint32_t h;
+
+	memcpy(&h, msg, 4);
+	return crc_clmul(__builtin_bswap32(h));
+}
+
+static uint32_t
+crc112_clmul(const uint8_t *msg) {
+	uint64_t h;
+	uint32_t crc;
+
+	memcpy(&h, msg, 8);
+	crc = crc_clmul(__builtin_bswap64(h));
+
+	return crc_clmul(crc ^ (msg[8] << 16 | msg[9] << 8 | msg[10]));
+}
+#endif
+
+static uint32_t crc56_dispatch(const uint8_t *msg);
+static uint32_t crc112_dispatch(const uint8_t *msg);
+static uint32_t (*crc56_impl)(const uint8_t *) = crc56_dispatch;
+static uint32_t (*crc112_impl)(const uint8_t *) = crc112_dispatch;
+
+/*
+ * Pick the best implementations on first use.
+ */
+static void
+crc_pick(void) {
+#ifdef CRC_CLMUL
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("pclmul")) {
+		crc56_impl = crc56_clmul;
+		crc112_impl = crc112_clmul;
+		return;
+	}
+#endif
+	crc56_impl = crc56_sliced;
+	crc112_impl = crc112_sliced;
+}
+
+static uint32_t
+crc56_dispatch(const uint8_t *msg) {
+	crc_pick();
+	return crc56_impl(msg);
+}
+
+static uint32_t
+crc112_dispatch(const uint8_t *msg) {
+	crc_pick();
+	return crc112_impl(msg);
+}
+
+/*
+ * Parity of short and long messages, respectively.
+ */
+uint32_t
+checksum56(const uint8_t *msg) {
+	return crc56_impl(msg);
+}
+
+uint32_t
+checksum112(const uint8_t *msg) {
+	return crc112_impl(msg);
+}
+
+uint32_t
+checksum(const uint8_t *msg, size_t len) {
+	if (len == 7)
+		return crc56_impl(msg);
+	if (len == 14)
+		return crc112_impl(msg);
+	return 0x0F000000;
+}
 
 uint32_t
 crc_syndrome(const uint8_t *msg, size_t len) {
@@ -94,50 +278,210 @@ crc_syndrome(const uint8_t *msg, size_t len) {
 	return crc ^ sum;
 }
 
+#define CRC_AP(msg, len) ((uint32_t)(msg)[(len) - 3] << 16 \
+                        | (uint32_t)(msg)[(len) - 2] <<  8 \
+                        | (uint32_t)(msg)[(len) - 1])
+
 /*
- * Tables of syndromes for single bit errors.
- */
-static const uint32_t df17_syndromes[] = {
-	0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x9E31E9, 0xB0E2F0, 0x587178,
-	0x2C38BC, 0x161C5E, 0x0B0E2F, 0xFA7D13, 0x82C48D, 0xBE9842, 0x5F4C21, 0xD05C14,
-	0x682E0A, 0x341705, 0xE5F186, 0x72F8C3, 0xC68665, 0x9CB936, 0x4E5C9B, 0xD8D449,
-	0x939020, 0x49C810, 0x24E408, 0x127204, 0x093902, 0x049C81, 0xFDB444, 0x7EDA22,
-	0x3F6D11, 0xE04C8C, 0x702646, 0x381323, 0xE3F395, 0x8E03CE, 0x4701E7, 0xDC7AF7,
-	0x91C77F, 0xB719BB, 0xA476D9, 0xADC168, 0x56E0B4, 0x2B705A, 0x15B82D, 0xF52612,
-	0x7A9309, 0xC2B380, 0x6159C0, 0x30ACE0, 0x185670, 0x0C2B38, 0x06159C, 0x030ACE,
-	0x018567, 0xFF38B7, 0x80665F, 0xBFC92B, 0xA01E91, 0xAFF54C, 0x57FAA6, 0x2BFD53,
-	0xEA04AD, 0x8AF852, 0x457C29, 0xDD4410, 0x6EA208, 0x375104, 0x1BA882, 0x0DD441,
-	0xF91024, 0x7C8812, 0x3E4409, 0xE0D800, 0x706C00, 0x383600, 0x1C1B00, 0x0E0D80,
-	0x0706C0, 0x038360, 0x01C1B0, 0x00E0D8, 0x00706C, 0x003836, 0x001C1B, 0xFFF409,
-	0x800000, 0x400000, 0x200000, 0x100000, 0x080000, 0x040000, 0x020000, 0x010000,
-	0x008000, 0x004000, 0x002000, 0x001000, 0x000800, 0x000400, 0x000200, 0x000100,
-	0x000080, 0x000040, 0x000020, 0x000010, 0x000008, 0x000004, 0x000002, 0x000001
-};
+ * Syndromes of short messages, at idx into msgs, four at a
+ * time, so that each lookup needn't wait for the one before.
+ */
+static void
+crc56_batch(const uint8_t *const *msgs, const size_t *idx, size_t n, uint32_t *syns) {
+	const uint8_t *m0, *m1, *m2, *m3;
+	size_t i;
 
-static const uint32_t df11_syndromes[] = {
-	0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x9E31E9, 0xB0E2F0, 0x587178,
-	0x2C38BC, 0x161C5E, 0x0B0E2F, 0xFA7D13, 0x82C48D, 0xBE9842, 0x5F4C21, 0xD05C14,
-	0x682E0A, 0x341705, 0xE5F186, 0x72F8C3, 0xC68665, 0x9CB936, 0x4E5C9B, 0xD8D449,
-	0x939020, 0x49C810, 0x24E408, 0x127204, 0x093902, 0x049C81, 0xFDB444, 0x7EDA22,
-	0x800000, 0x400000, 0x200000, 0x100000, 0x080000, 0x040000, 0x020000, 0x010000,
-	0x008000, 0x004000, 0x002000, 0x001000, 0x000800, 0x000400, 0x000200, 0x000100,
-	0x000080, 0x000040, 0x000020, 0x000010, 0x000008, 0x000004, 0x000002, 0x000001
-};
+	for (i = 0; i + 4 <= n; i += 4) {
+		m0 = msgs[idx[i + 0]];
+		m1 = msgs[idx[i + 1]];
+		m2 = msgs[idx[i + 2]];
+		m3 = msgs[idx[i + 3]];
+		syns[idx[i + 0]] = CRC56_SLICE(m0) ^ CRC_AP(m0, 7);
+		syns[idx[i + 1]] = CRC56_SLICE(m1) ^ CRC_AP(m1, 7);
+		syns[idx[i + 2]] = CRC56_SLICE(m2) ^ CRC_AP(m2, 7);
+		syns[idx[i + 3]] = CRC56_SLICE(m3) ^ CRC_AP(m3, 7);
+	}
+	for (; i < n; ++i) {
+		m0 = msgs[idx[i]];
+		syns[idx[i]] = CRC56_SLICE(m0) ^ CRC_AP(m0, 7);
+	}
+}
 
-int
-errorbit(size_t len, uint32_t syn_M) {
-	const uint32_t *syn_table;
+/*
+ * As crc56_batch, for long messages. The second slice of
+ * each depends on its first, so all four first slices are
+ * found before any of the second.
+ */
+static void
+crc112_batch(const uint8_t *const *msgs, const size_t *idx, size_t n, uint32_t *syns) {
+	const uint8_t *m0, *m1, *m2, *m3;
+	uint32_t c0, c1, c2, c3;
 	size_t i;
-	
-	if (len == 14)
-		syn_table = df17_syndromes;
-	else
-		syn_table = df11_syndromes;
 
-	for (i = 0; i < len * 8; ++i) {
-		if (syn_M == syn_table[i]) {
-			return i;
+	for (i = 0; i + 4 <= n; i += 4) {
+		m0 = msgs[idx[i + 0]];
+		m1 = msgs[idx[i + 1]];
+		m2 = msgs[idx[i + 2]];
+		m3 = msgs[idx[i + 3]];
+		c0 = CRC112_HEAD(m0);
+		c1 = CRC112_HEAD(m1);
+		c2 = CRC112_HEAD(m2);
+		c3 = CRC112_HEAD(m3);
+		syns[idx[i + 0]] = CRC112_TAIL(m0, c0) ^ CRC_AP(m0, 14);
+		syns[idx[i + 1]] = CRC112_TAIL(m1, c1) ^ CRC_AP(m1, 14);
+		syns[idx[i + 2]] = CRC112_TAIL(m2, c2) ^ CRC_AP(m2, 14);
+		syns[idx[i + 3]] = CRC112_TAIL(m3, c3) ^ CRC_AP(m3, 14);
+	}
+	for (; i < n; ++i) {
+		m0 = msgs[idx[i]];
+		syns[idx[i]] = crc112_sliced(m0) ^ CRC_AP(m0, 14);
+	}
+}
+
+/*
+ * Syndromes of n messages, msgs[i] being lens[i] bytes long,
+ * into syns[i], as crc_syndrome. Messages are sorted by length
+ * a block at a time, without branching on it, as short and long
+ * ones come in no particular order, so that the kernels see only
+ * one kind.
+ * Lengths other than 7 and 14 give 0x0F000000, as checksum.
+ */
+void
+crc_syndromes(const uint8_t *const *msgs, const size_t *lens, uint32_t *syns, size_t n) {
+	size_t shorts[CRC_BATCH];
+	size_t longs[CRC_BATCH];
+	size_t ns, nl, nodd;
+	size_t i, j;
+
+	for (i = 0; i < n; i += CRC_BATCH) {
+		ns = nl = nodd = 0;
+		for (j = i; j < n && j < i + CRC_BATCH; ++j) {
+			shorts[ns] = j;
+			longs[nl] = j;
+			ns += lens[j] == 7;
+			nl += lens[j] == 14;
+			if (ns + nl + nodd == j - i) {
+				syns[j] = 0x0F000000;
+				++nodd;
+			}
 		}
+		crc56_batch(msgs, shorts, ns, syns);
+		crc112_batch(msgs, longs, nl, syns);
 	}
-	return -1;
+}
+
+struct crc_fix_tbl_t {
+	const uint32_t *syn;
+	const uint16_t *slots;
+	unsigned bits;
+	uint32_t mask;
+};
+
+static const struct crc_fix_tbl_t fix_short = { crc_syn_short, crc_fix_short, FIX_SHORT_BITS, 0xFFFFFF };
+static const struct crc_fix_tbl_t fix_iid = { crc_syn_short, crc_fix_iid, FIX_SHORT_BITS, CRC_IID_MASK };
+static const struct crc_fix_tbl_t fix_long = { crc_syn_long, crc_fix_long, FIX_LONG_BITS, 0xFFFFFF };
+
+static size_t
+fix_slot(const struct crc_fix_tbl_t *t, uint32_t key) {
+	return (uint32_t)(key * 0x9E3779B1u) >> (32 - t->bits);
+}
+
+/*
+ * Syndrome of a pattern of bits, as kept in a slot.
+ */
+static uint32_t
+fix_syn(const struct crc_fix_tbl_t *t, unsigned e) {
+	uint32_t syn = t->syn[(e & 0x7F) - 1];
+
+	if (e & 0x3F80)
+		syn ^= t->syn[((e >> 7) & 0x7F) - 1];
+	return syn;
+}
+
+/*
+ * Slot holding the pattern for syndrome key, or the empty
+ * slot where it would be.
+ */
+static size_t
+fix_find(const struct crc_fix_tbl_t *t, uint32_t key) {
+	size_t mask = ((size_t)1 << t->bits) - 1;
+	size_t i;
+
+	for (i = fix_slot(t, key); t->slots[i]; i = (i + 1) & mask) {
+		if ((fix_syn(t, t->slots[i]) & t->mask) == key)
+			break;
+	}
+	return i;
+}
+
+/*
+ * Bits in error of a message of len bytes with syndrome syn,
+ * of which only the bits in mask are known, either 0xFFFFFF,
+ * or CRC_IID_MASK for short messages with an interrogator
+ * identifier overlaid. Up to depth, at most two, bits are corrected,
+ * and their positions, from the first bit of the message,
+ * put in bits. Returns how many, or -1 if there are more, or
+ * if the fix would be ambiguous.
+ *
+ * With an interrogator identifier, only 17 bits of the syndrome
+ * are known, and about 1600 of its 131072 values would be taken
+ * for two bits in error, so that about 1.2% of garbage would be
+ * "fixed". Only one bit is corrected then, whatever depth is.
+ */
+int
+crc_error_bits(size_t len, uint32_t syn, uint32_t mask, int depth, int *bits) {
+	const struct crc_fix_tbl_t *t;
+	unsigned e;
+
+	if (len == 14 && mask == 0xFFFFFF)
+		t = &fix_long;
+	else if (len == 7 && mask == 0xFFFFFF)
+		t = &fix_short;
+	else if (len == 7 && mask == CRC_IID_MASK)
+		t = &fix_iid;
+	else
+		return -1;
+
+	if (!(syn &= mask))
+		return 0;
+	if (mask == CRC_IID_MASK && depth > 1)
+		depth = 1;
+
+	if (!(e = t->slots[fix_find(t, syn)]) || e & FIX_REJECT)
+		return -1;
+
+	bits[0] = (e & 0x7F) - 1;
+	if (!(e & 0x3F80))
+		return depth >= 1 ? 1 : -1;
+	bits[1] = ((e >> 7) & 0x7F) - 1;
+	return depth >= 2 ? 2 : -1;
+}
+
+/*
+ * Syndrome of a message of len bytes with syndrome syn, once
+ * the n bits found by crc_error_bits are flipped, without
+ * computing it anew. It's 0, or for short messages with an
+ * interrogator identifier overlaid, the identifier.
+ */
+uint32_t
+crc_fixed_syndrome(size_t len, uint32_t syn, const int *bits, int n) {
+	const uint32_t *t = len == 14 ? crc_syn_long : crc_syn_short;
+	int i;
+
+	for (i = 0; i < n; ++i)
+		syn ^= t[bits[i]];
+	return syn;
+}
+
+/*
+ * The bit in error of a message of len bytes with syndrome
+ * syn_M, or -1 if there isn't exactly one.
+ */
+int
+errorbit(size_t len, uint32_t syn_M) {
+	int bits[2];
+
+	if (crc_error_bits(len, syn_M, 0xFFFFFF, 1, bits) != 1)
+		return -1;
+	return bits[0];
 }
@@ -1,8 +1,24 @@
 #ifndef _MS_CRC_H
 #define _MS_CRC_H
 
+/*
+ * Parity bits known of short messages with an interrogator
+ * identifier overlaid, as DF11.
+ */
+#define CRC_IID_MASK 0xFFFF80
+
+/*
+ * Messages sorted by length at a time, by crc_syndromes.
+ */
+#define CRC_BATCH 64
+
 uint32_t checksum(const uint8_t *msg, size_t len);
+uint32_t checksum56(const uint8_t *msg);
+uint32_t checksum112(const uint8_t *msg);
 uint32_t crc_syndrome(const uint8_t *msg, size_t len);
+void crc_syndromes(const uint8_t *const *msgs, const size_t *lens, uint32_t *syns, size_t n);
+int crc_error_bits(size_t len, uint32_t syn, uint32_t mask, int depth, int *bits);
+uint32_t crc_fixed_syndrome(size_t len, uint32_t syn, const int *bits, int n);
 int errorbit(size_t len, uint32_t syn_M);
 
 #endif
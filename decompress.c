@@ -0,0 +1,261 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <zlib.h>
+#include <lzma.h>
+
+#include "decompress.h"
+
+#define DECOMP_BUFSIZE (128 * 1024)
+
+/*
+ * Compressed input is inflated on a thread of its own, which
+ * writes to a pipe that's read as any other input. The pipe
+ * is the bounded buffer between the two, so the thread keeps
+ * at most a pipe full ahead of the parser.
+ */
+struct ms_decompressor_t {
+	pthread_t thread;
+	enum ms_compression_t type;
+	int in;
+	int out[2];
+	uint8_t *prefix;
+	size_t prefix_len;
+	bool stopped; /* by the reader closing the pipe */
+	bool failed;
+};
+
+enum ms_compression_t
+compression_of(const uint8_t *buf, size_t len) {
+	if (len >= 2 && buf[0] == 0x1F && buf[1] == 0x8B)
+		return COMPRESSION_GZIP;
+	if (len >= 6 && !memcmp(buf, "\375" "7zXZ\0", 6))
+		return COMPRESSION_XZ;
+	return COMPRESSION_NONE;
+}
+
+static int
+write_all(int fd, const uint8_t *buf, size_t len) {
+	while (len) {
+		ssize_t n = write(fd, buf, len);
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += n;
+		len -= n;
+	}
+	return 0;
+}
+
+/*
+ * Fills buf with the prefix, if any is left, or from the input.
+ */
+static ssize_t
+read_in(struct ms_decompressor_t *d, uint8_t *buf, size_t len) {
+	ssize_t n;
+
+	if (d->prefix_len) {
+		n = d->prefix_len < len ? d->prefix_len : len;
+		memcpy(buf, d->prefix, n);
+		memmove(d->prefix, d->prefix + n, d->prefix_len - n);
+		d->prefix_len -= n;
+		return n;
+	}
+
+	do {
+		n = read(d->in, buf, len);
+	} while (n < 0 && errno == EINTR);
+
+	return n;
+}
+
+static int
+gunzip(struct ms_decompressor_t *d, uint8_t *in, uint8_t *out) {
+	z_stream z;
+	int ret = Z_OK;
+	ssize_t n;
+
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, 15 + 16) != Z_OK)
+		return -1;
+
+	while ((n = read_in(d, in, DECOMP_BUFSIZE)) > 0) {
+		z.next_in = in;
+		z.avail_in = n;
+
+		do {
+			/*
+			 * Rotated logs are often concatenated,
+			 * so there may be more than one member.
+			 */
+			if (ret == Z_STREAM_END) {
+				if (!z.avail_in || inflateReset(&z) != Z_OK)
+					break;
+			}
+
+			z.next_out = out;
+			z.avail_out = DECOMP_BUFSIZE;
+			ret = inflate(&z, Z_NO_FLUSH);
+
+			if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+				goto done;
+			if (write_all(d->out[1], out, DECOMP_BUFSIZE - z.avail_out) < 0) {
+				d->stopped = true;
+				goto done;
+			}
+		} while (z.avail_in || !z.avail_out);
+	}
+
+done:
+	inflateEnd(&z);
+	return n < 0 || ret != Z_STREAM_END ? -1 : 0;
+}
+
+static int
+unxz(struct ms_decompressor_t *d, uint8_t *in, uint8_t *out) {
+	lzma_stream s = LZMA_STREAM_INIT;
+	lzma_action action = LZMA_RUN;
+	lzma_ret ret = LZMA_OK;
+
+	if (lzma_stream_decoder(&s, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+		return -1;
+
+	while (ret == LZMA_OK) {
+		if (!s.avail_in && action == LZMA_RUN) {
+			ssize_t n = read_in(d, in, DECOMP_BUFSIZE);
+
+			if (n < 0)
+				break;
+			if (n == 0)
+				action = LZMA_FINISH;
+			s.next_in = in;
+			s.avail_in = n;
+		}
+
+		s.next_out = out;
+		s.avail_out = DECOMP_BUFSIZE;
+		ret = lzma_code(&s, action);
+
+		if (write_all(d->out[1], out, DECOMP_BUFSIZE - s.avail_out) < 0) {
+			d->stopped = true;
+			break;
+		}
+	}
+
+	lzma_end(&s);
+	return ret == LZMA_STREAM_END ? 0 : -1;
+}
+
+static void *
+decompress(void *arg) {
+	struct ms_decompressor_t *d = arg;
+	uint8_t *in = malloc(DECOMP_BUFSIZE);
+	uint8_t *out = malloc(DECOMP_BUFSIZE);
+	sigset_t set;
+	int ret;
+
+	/*
+	 * The reader may be done before we are, and
+	 * close its end of the pipe. EPIPE will do.
+	 */
+	sigemptyset(&set);
+	sigaddset(&set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	if (d->type == COMPRESSION_GZIP)
+		ret = gunzip(d, in, out);
+	else
+		ret = unxz(d, in, out);
+
+	d->failed = ret < 0 && !d->stopped;
+	close(d->out[1]);
+	free(in);
+	free(out);
+	return NULL;
+}
+
+/*
+ * Takes over fd. The first len bytes of input, if they
+ * had to be read to tell the compression, are in prefix.
+ */
+struct ms_decompressor_t *
+mk_decompressor(int fd, enum ms_compression_t type, const uint8_t *prefix, size_t len) {
+	struct ms_decompressor_t *d;
+
+	d = calloc(1, sizeof(struct ms_decompressor_t));
+	d->type = type;
+	d->in = fd;
+	if (len) {
+		d->prefix = malloc(len);
+		memcpy(d->prefix, prefix, len);
+		d->prefix_len = len;
+	}
+
+	if (pipe(d->out) < 0) {
+		free(d->prefix);
+		free(d);
+		return NULL;
+	}
+
+	if ((errno = pthread_create(&d->thread, NULL, decompress, d))) {
+		close(d->out[0]);
+		close(d->out[1]);
+		free(d->prefix);
+		free(d);
+		return NULL;
+	}
+
+	return d;
+}
+
+int
+decompressor_fd(const struct ms_decompressor_t *d) {
+	return d->out[0];
+}
+
+/*
+ * Returns -1, with errno set to EIO, if the input was corrupt,
+ * truncated, or couldn't be read. Input left unread because
+ * the reader was done first isn't an error.
+ */
+int
+destroy_decompressor(struct ms_decompressor_t *d) {
+	int ret;
+
+	close(d->out[0]);
+	pthread_join(d->thread, NULL);
+	ret = d->failed ? -1 : 0;
+
+	close(d->in);
+	free(d->prefix);
+	free(d);
+
+	if (ret < 0)
+		errno = EIO;
+	return ret;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_DECOMPRESS_H
+#define _MS_DECOMPRESS_H
+
+#include <sys/types.h>
+#include <stdint.h>
+
+enum ms_compression_t {
+	COMPRESSION_NONE,
+	COMPRESSION_GZIP,
+	COMPRESSION_XZ
+};
+
+#define COMPRESSION_MAGIC_LEN 6
+
+struct ms_decompressor_t;
+
+enum ms_compression_t compression_of(const uint8_t *buf, size_t len);
+struct ms_decompressor_t *mk_decompressor(int fd, enum ms_compression_t,
+                                          const uint8_t *prefix, size_t len);
+int decompressor_fd(const struct ms_decompressor_t *d);
+int destroy_decompressor(struct ms_decompressor_t *d);
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "dedup.h"
+#include "parse.h"
+
+#define DEDUP_MINSIZE 1024
+
+struct ms_dedup_t *
+mk_dedup(time_t window) {
+	struct ms_dedup_t *d;
+
+	d = calloc(1, sizeof(struct ms_dedup_t));
+	d->window = window > 0 ? window : 1;
+	d->cur.size = DEDUP_MINSIZE;
+	d->cur.slots = calloc(d->cur.size, sizeof(struct ms_dedup_entry_t));
+	d->prev.size = DEDUP_MINSIZE;
+	d->prev.slots = calloc(d->prev.size, sizeof(struct ms_dedup_entry_t));
+
+	return d;
+}
+
+/*
+ * FNV-1a
+ */
+static uint32_t
+hash(const uint8_t *raw, size_t len) {
+	uint32_t h = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < len; ++i) {
+		h ^= raw[i];
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/*
+ * The slot of raw in set, or the empty one where it belongs.
+ */
+static struct ms_dedup_entry_t *
+lookup(struct ms_dedup_set_t *set, const uint8_t *raw, size_t len) {
+	size_t i = hash(raw, len) & (set->size - 1);
+
+	for (;;) {
+		struct ms_dedup_entry_t *e = &set->slots[i];
+
+		if (!e->len || (e->len == len && !memcmp(e->raw, raw, len)))
+			return e;
+		i = (i + 1) & (set->size - 1);
+	}
+}
+
+static void
+grow(struct ms_dedup_set_t *set) {
+	struct ms_dedup_entry_t *old = set->slots;
+	size_t size = set->size;
+	size_t i;
+
+	set->size *= 2;
+	set->slots = calloc(set->size, sizeof(struct ms_dedup_entry_t));
+
+	for (i = 0; i < size; ++i)
+		if (old[i].len)
+			*lookup(set, old[i].raw, old[i].len) = old[i];
+	free(old);
+}
+
+static void
+clear(struct ms_dedup_set_t *set) {
+	memset(set->slots, 0, set->size * sizeof(struct ms_dedup_entry_t));
+	set->n = 0;
+}
+
+static bool
+within(const struct ms_dedup_t *d, const struct ms_dedup_entry_t *e, time_t t) {
+	return e->len && (t < e->time ? e->time - t : t - e->time) < d->window;
+}
+
+/*
+ * Returns true if the same message has been seen less than
+ * window seconds before (or after, for input out of order).
+ */
+bool
+is_duplicate(struct ms_dedup_t *d, const struct ms_frame_t *frame) {
+	struct ms_dedup_entry_t *e;
+	time_t t = frame->time;
+
+	if (!d->start)
+		d->start = t;
+
+	if (t - d->start >= d->window) {
+		struct ms_dedup_set_t tmp = d->prev;
+
+		d->prev = d->cur;
+		d->cur = tmp;
+		clear(&d->cur);
+		if (t - d->start >= 2 * d->window)
+			clear(&d->prev);
+		d->start = t;
+	}
+
+	if (within(d, lookup(&d->prev, frame->raw, frame->len), t)) {
+		d->suppressed += 1;
+		return true;
+	}
+
+	e = lookup(&d->cur, frame->raw, frame->len);
+	if (within(d, e, t)) {
+		d->suppressed += 1;
+		return true;
+	}
+
+	if (!e->len) {
+		if (2 * (d->cur.n + 1) > d->cur.size) {
+			grow(&d->cur);
+			e = lookup(&d->cur, frame->raw, frame->len);
+		}
+		d->cur.n += 1;
+		e->len = frame->len;
+		memcpy(e->raw, frame->raw, frame->len);
+	}
+	e->time = t;
+
+	return false;
+}
+
+void
+destroy_dedup(struct ms_dedup_t *d) {
+	free(d->cur.slots);
+	free(d->prev.slots);
+	free(d);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_DEDUP_H
+#define _MS_DEDUP_H
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+struct ms_frame_t;
+
+struct ms_dedup_entry_t {
+	time_t time;
+	uint8_t len; /* 0 if unused */
+	uint8_t raw[14];
+};
+
+struct ms_dedup_set_t {
+	struct ms_dedup_entry_t *slots;
+	size_t size;
+	size_t n;
+};
+
+/*
+ * Messages seen within the last window seconds are kept in
+ * two sets, one for the current window and one for the one
+ * before, which is dropped as a whole when time moves on.
+ */
+struct ms_dedup_t {
+	time_t window;
+	time_t start; /* of the current set */
+	struct ms_dedup_set_t cur;
+	struct ms_dedup_set_t prev;
+	size_t suppressed;
+};
+
+struct ms_dedup_t *mk_dedup(time_t window);
+bool is_duplicate(struct ms_dedup_t *d, const struct ms_frame_t *frame);
+void destroy_dedup(struct ms_dedup_t *d);
+
+#endif
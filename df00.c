@@ -34,12 +34,8 @@
  *  0       1       2       3       4       5       6  
  *
  */
-struct ms_DF00_t *
-mk_DF00(const uint8_t *msg) {
-	struct ms_DF00_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF00_t));
-
+void
+mk_DF00(struct ms_DF00_t *ret, const uint8_t *msg) {
 	/* VS - Vertical status, bit 6 */
 	ret->VS = msg[0] & 0x04;
 	/* CC - Cross-link capability, bit 7 */
@@ -62,8 +58,6 @@ mk_DF00(const uint8_t *msg) {
 	ret->AP = (msg[4] << 16)
 	        | (msg[5] <<  8)
 	        | (msg[6] <<  0);
-
-	return ret;
 }
 
 void
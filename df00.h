@@ -28,7 +28,7 @@ struct ms_DF00_t {
 	struct ms_AC_t AC;
 	uint32_t AP;
 };
-struct ms_DF00_t *mk_DF00(const uint8_t *msg);
+void mk_DF00(struct ms_DF00_t *ret, const uint8_t *msg);
 void pr_DF00(FILE *fp, struct ms_DF00_t *p, int);
 
 #endif
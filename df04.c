@@ -32,12 +32,8 @@
  *  0       1       2       3       4       5       6  
  *
  */
-struct ms_DF04_t*
-mk_DF04(const uint8_t *msg) {
-	struct ms_DF04_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF04_t));
-	
+void
+mk_DF04(struct ms_DF04_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->AP = (msg[4] << 16)
 	        | (msg[5] <<  8)
@@ -61,9 +57,6 @@ mk_DF04(const uint8_t *msg) {
 	ret->AC.alt_ft = decode_AC(ret->AC.raw, true);
 	ret->AC.Q = ret->AC.raw & 0x10;
 	ret->AC.M = ret->AC.raw & 0x40;
-
-
-	return ret;
 }
 
 void
@@ -27,7 +27,7 @@ struct ms_DF04_t {
 	struct ms_AC_t AC;
 	uint32_t AP;
 };
-struct ms_DF04_t *mk_DF04(const uint8_t *msg);
+void mk_DF04(struct ms_DF04_t *ret, const uint8_t *msg);
 void pr_DF04(FILE *fp, struct ms_DF04_t *p, int);
 
 
@@ -32,13 +32,10 @@
  *  0       1       2       3       4       5       6  
  *
  */
-struct ms_DF05_t*
-mk_DF05(const uint8_t *msg) {
-	struct ms_DF05_t *ret;
+void
+mk_DF05(struct ms_DF05_t *ret, const uint8_t *msg) {
 	uint16_t tmp;
 
-	ret = calloc(1, sizeof(struct ms_DF05_t));
-	
 	ret->DF = msg[0] >> 3;
 	ret->AP = (msg[4] << 16)
 	        | (msg[5] <<  8)
@@ -54,8 +51,6 @@ mk_DF05(const uint8_t *msg) {
 	/* ID - Identity 3.1.1.6 */
 	tmp = ((msg[2] << 8) | msg[3]) & 0x1FFF;
 	ret->ID = decode_ID(tmp);
-
-	return ret;
 }
 
 void
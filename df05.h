@@ -27,7 +27,7 @@ struct ms_DF05_t {
 	uint16_t ID;
 	uint32_t AP;
 };
-struct ms_DF05_t *mk_DF05(const uint8_t *msg);
+void mk_DF05(struct ms_DF05_t *ret, const uint8_t *msg);
 void pr_DF05(FILE *fp, struct ms_DF05_t *p, int);
 
 
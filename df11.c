@@ -31,12 +31,8 @@
  *  0       1       2       3       4       5       6  
  *
  */
-struct ms_DF11_t *
-mk_DF11(const uint8_t *msg) {
-	struct ms_DF11_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF11_t));
-	
+void
+mk_DF11(struct ms_DF11_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->PI = (msg[4] << 16)
 	        | (msg[5] <<  8)
@@ -49,8 +45,6 @@ mk_DF11(const uint8_t *msg) {
 	ret->AA.addr = (msg[1] << 16)
 	             | (msg[2] <<  8)
 	             | (msg[3] <<  0);
-
-	return ret;
 }
 
 void 
@@ -25,7 +25,7 @@ struct ms_DF11_t {
 	struct ms_AA_t AA;
 	uint32_t PI;
 };
-struct ms_DF11_t *mk_DF11(const uint8_t *msg);
+void mk_DF11(struct ms_DF11_t *ret, const uint8_t *msg);
 void pr_DF11(FILE *fp, struct ms_DF11_t *p, int);
 
 #endif
@@ -35,12 +35,8 @@
  *                     2109876543210
  *
  */
-struct ms_DF16_t *
-mk_DF16(const uint8_t *msg) {
-	struct ms_DF16_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF16_t));
-	
+void
+mk_DF16(struct ms_DF16_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->AP = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -64,17 +60,16 @@ mk_DF16(const uint8_t *msg) {
 	ret->VDS = msg[4];
 
 	if (ret->VDS == 0x30) {
-		ret->aux = mk_BDS_30(msg + 4);
+		mk_BDS_30(&ret->aux.u.BDS_30, msg + 4);
+		ret->aux.type = AUX_BDS_30;
 	}
-
-	return ret;
 }
 
 static void
-pr_VDS(FILE *fp, uint8_t vds, void *aux, int v) {
+pr_VDS(FILE *fp, uint8_t vds, const struct ms_aux_t *aux, int v) {
 	fprintf(fp, "VDS:%02X\n", vds);
 	if (vds == 0x30)
-		pr_BDS_30(fp, aux, v);
+		pr_BDS_30(fp, &aux->u.BDS_30, v);
 
 }
 
@@ -98,6 +93,6 @@ pr_DF16(FILE *fp, struct ms_DF16_t *p, int v) {
 		pr_SL(fp, p->SL);
 		pr_RI(fp, p->RI);
 		pr_AC(fp, &p->AC);
-		pr_VDS(fp, p->VDS, p->aux, v);
+		pr_VDS(fp, p->VDS, &p->aux, v);
 	}
 }
@@ -18,6 +18,7 @@
 #define _MS_DF16_H
 
 #include "fields.h"
+#include "aux.h"
 
 struct ms_DF16_t {
 	uint8_t DF;
@@ -26,10 +27,10 @@ struct ms_DF16_t {
 	uint8_t RI;
 	struct ms_AC_t AC;
 	uint8_t VDS;
-	void *aux;
+	struct ms_aux_t aux;
 	uint32_t AP;
 };
-struct ms_DF16_t *mk_DF16(const uint8_t *msg);
+void mk_DF16(struct ms_DF16_t *ret, const uint8_t *msg);
 void pr_DF16(FILE *fp, struct ms_DF16_t *p, int);
 
 #endif
@@ -31,12 +31,8 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF17_t *
-mk_DF17(const uint8_t *msg) {
-	struct ms_DF17_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF17_t));
-
+void
+mk_DF17(struct ms_DF17_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->PI = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -56,9 +52,8 @@ mk_DF17(const uint8_t *msg) {
 	 * [3] B.2.3.1
 	 */
 	mk_ES_TYPE(&ret->ES_TYPE, msg[4]);
-	ret->aux = mk_extended_squitter(msg + 4, ret->ES_TYPE.et);
+	mk_extended_squitter(&ret->aux, msg + 4, ret->ES_TYPE.et);
 	
-	return ret;
 }
 
 void
@@ -71,13 +66,13 @@ pr_DF17(FILE *fp, struct ms_DF17_t *p, int v) {
 		pr_raw(fp,  6,   8, p->CA, "CA");
 		pr_raw(fp,  9,  32, p->AA.addr, "AA");
 		pr_raw_subfield_header(fp, 33, 88, "Extended squitter");
-		pr_extended_squitter(fp, p->aux, &p->ES_TYPE, v);
+		pr_extended_squitter(fp, &p->aux, &p->ES_TYPE, v);
 		pr_raw_subfield_footer(fp);
 		pr_raw(fp, 89, 112, p->PI, "PI");
 		pr_raw_footer(fp);
 	} else {
 		pr_CA(fp, p->CA);
 		pr_AA(fp, p->AA);
-		pr_extended_squitter(fp, p->aux, &p->ES_TYPE, v);
+		pr_extended_squitter(fp, &p->aux, &p->ES_TYPE, v);
 	}
 }
@@ -18,6 +18,7 @@
 #define _MS_DF17_H
 
 #include "fields.h"
+#include "aux.h"
 #include "es.h"
 
 struct ms_DF17_t {
@@ -25,10 +26,10 @@ struct ms_DF17_t {
 	uint8_t CA;
 	struct ms_AA_t AA;
 	struct ms_ES_TYPE_t ES_TYPE;
-	void *aux; /* ME */
+	struct ms_aux_t aux; /* ME */
 	uint32_t PI;
 };
-struct ms_DF17_t *mk_DF17(const uint8_t *msg);
+void mk_DF17(struct ms_DF17_t *ret, const uint8_t *msg);
 void pr_DF17(FILE *fp, struct ms_DF17_t *p, int);
 
 
@@ -36,13 +36,10 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF18_t *
-mk_DF18(const uint8_t *msg) {
-	struct ms_DF18_t *ret;
+void
+mk_DF18(struct ms_DF18_t *ret, const uint8_t *msg) {
 	uint32_t addr;
 
-	ret = calloc(1, sizeof(struct ms_DF18_t));
-	
 	ret->DF = msg[0] >> 3;
 	ret->PI = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -76,13 +73,15 @@ mk_DF18(const uint8_t *msg) {
 	case 1: /* ADS-B ES/NT (non-ICAO) */
 	case 6: /* ADS-B rebroadcast */
 		mk_ES_TYPE(&ret->ES_TYPE, msg[4]);
-		ret->aux = mk_extended_squitter(msg + 4, ret->ES_TYPE.et);
+		mk_extended_squitter(&ret->aux, msg + 4, ret->ES_TYPE.et);
 		break;
 	case 2: /* Fine TIS-B */
-		ret->aux = mk_TISB_fine(msg + 4);
+		mk_TISB_fine(&ret->aux.u.TISB_fine, msg + 4);
+		ret->aux.type = AUX_TISB_FINE;
 		break;	
 	case 3: /* Coarse TIS-B */
-		ret->aux = mk_TISB_coarse(msg + 4);
+		mk_TISB_coarse(&ret->aux.u.TISB_coarse, msg + 4);
+		ret->aux.type = AUX_TISB_COARSE;
 		break;
 	case 4: /* TIS-B management msg, TODO */
 		break;
@@ -91,8 +90,6 @@ mk_DF18(const uint8_t *msg) {
 	case 7: /* Reserved */
 		break;
 	}
-
-	return ret;
 }
 
 /*
@@ -130,13 +127,13 @@ pr_DF18(FILE *fp, struct ms_DF18_t *p, int v) {
 	case 0:
 	case 1:
 	case 6:
-		pr_extended_squitter(fp, p->aux, &p->ES_TYPE, v);
+		pr_extended_squitter(fp, &p->aux, &p->ES_TYPE, v);
 		break;
 	case 2: /* Fine TIS-B */
-		pr_TISB_fine(fp, p->aux, v);
+		pr_TISB_fine(fp, &p->aux.u.TISB_fine, v);
 		break;	
 	case 3: /* Coarse TIS-B */
-		pr_TISB_coarse(fp, p->aux, v);
+		pr_TISB_coarse(fp, &p->aux.u.TISB_coarse, v);
 		break;
 	case 4: /* TIS-B management msg */
 		fprintf(fp, "TIS-B management message:TODO\n");
@@ -18,6 +18,7 @@
 #define _MS_DF18_H
 
 #include "fields.h"
+#include "aux.h"
 #include "es.h"
 
 struct ms_MATF_t {
@@ -34,11 +35,11 @@ struct ms_DF18_t {
 	} AAu;
 	bool IMF;
 	struct ms_ES_TYPE_t ES_TYPE;
-	void *aux;
+	struct ms_aux_t aux;
 	uint32_t PI;
 };
 
-struct ms_DF18_t *mk_DF18(const uint8_t *msg);
+void mk_DF18(struct ms_DF18_t *ret, const uint8_t *msg);
 void pr_DF18(FILE *fp, struct ms_DF18_t *p, int);
 
 #endif
@@ -36,12 +36,8 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF19_t *
-mk_DF19(const uint8_t *msg) {
-	struct ms_DF19_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF19_t));
-	
+void
+mk_DF19(struct ms_DF19_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->PI = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -61,7 +57,7 @@ mk_DF19(const uint8_t *msg) {
 		ret->AA.addr = (msg[1] << 16)
 			     | (msg[2] <<  8)
 			     | (msg[3] <<  0);
-		ret->aux = mk_extended_squitter(msg + 4, ret->ES_TYPE.et);
+		mk_extended_squitter(&ret->aux, msg + 4, ret->ES_TYPE.et);
 		mk_ES_TYPE(&ret->ES_TYPE, msg[4]);
 		break;
 	case 1:
@@ -77,10 +73,11 @@ mk_DF19(const uint8_t *msg) {
 		 * a 56 bit BDS would fit.
 		 */
 #define TRY_MK_F2_AT(x)                                     \
-		if ((msg[(x)] >> 3) == 1)                   \
-			ret->aux = mk_BDS_F2(msg + (x));    \
-		if (ret->aux)                               \
-			break /* [sic] no semi-colon */
+		if ((msg[(x)] >> 3) == 1) {                 \
+			mk_BDS_F2(&ret->aux.u.BDS_F2, msg + (x)); \
+			ret->aux.type = AUX_BDS_F2;         \
+			break;                              \
+		}
 
 		TRY_MK_F2_AT(4);
 		TRY_MK_F2_AT(1);
@@ -95,8 +92,6 @@ mk_DF19(const uint8_t *msg) {
 		/* Reserved */
 		{}
 	}
-
-	return ret;
 }
 
 void
@@ -115,15 +110,15 @@ pr_DF19(FILE *fp, struct ms_DF19_t *p, int v) {
 	switch (p->AF) {
 	case 0:
 		pr_AA(fp, p->AA);
-		if (p->aux)
-			pr_extended_squitter(fp, p->aux, &p->ES_TYPE, v);
+		if (p->aux.type != AUX_NONE)
+			pr_extended_squitter(fp, &p->aux, &p->ES_TYPE, v);
 		break;
 	case 1:
 		fprintf(fp, "AF=1:Formation flight:TODO\n");
 		break;
 	case 2:
-		if (p->aux)
-			pr_BDS_F2(fp, p->aux, v);
+		if (p->aux.type == AUX_BDS_F2)
+			pr_BDS_F2(fp, &p->aux.u.BDS_F2, v);
 		else
 			fprintf(fp, "AF=2:Military application:TODO\n");
 		break;
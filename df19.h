@@ -18,6 +18,7 @@
 #define _MS_DF19_H
 
 #include "fields.h"
+#include "aux.h"
 #include "es.h"
 
 struct ms_DF19_t {
@@ -25,10 +26,10 @@ struct ms_DF19_t {
 	uint8_t AF;
 	struct ms_AA_t AA;
 	struct ms_ES_TYPE_t ES_TYPE;
-	void *aux;
+	struct ms_aux_t aux;
 	uint32_t PI;
 };
-struct ms_DF19_t *mk_DF19(const uint8_t *msg);
+void mk_DF19(struct ms_DF19_t *ret, const uint8_t *msg);
 void pr_DF19(FILE *fp, struct ms_DF19_t *p, int);
 
 
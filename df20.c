@@ -32,12 +32,8 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF20_t *
-mk_DF20(const uint8_t *msg) {
-	struct ms_DF20_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF20_t));
-	
+void
+mk_DF20(struct ms_DF20_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 3;
 	ret->AP = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -58,8 +54,6 @@ mk_DF20(const uint8_t *msg) {
 	ret->AC.alt_ft = decode_AC(ret->AC.raw, true);
 	ret->AC.M = ret->AC.raw & 0x40;
 	ret->AC.Q = ret->AC.raw & 0x10;
-
-	return ret;
 }
 
 void
@@ -18,6 +18,7 @@
 #define _MS_DF20_H
 
 #include "fields.h"
+#include "aux.h"
 
 struct ms_DF20_t {
 	uint8_t DF;
@@ -25,11 +26,11 @@ struct ms_DF20_t {
 	uint8_t DR;
 	struct ms_UM_t UM;
 	struct ms_AC_t AC;
-	void *aux;
+	struct ms_aux_t aux;
 	uint32_t AP;
 };
 
-struct ms_DF20_t *mk_DF20(const uint8_t *msg);
+void mk_DF20(struct ms_DF20_t *ret, const uint8_t *msg);
 void pr_DF20(FILE *fp, struct ms_DF20_t *p, int);
 
 #endif
@@ -31,13 +31,10 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF21_t *
-mk_DF21(const uint8_t *msg) {
-	struct ms_DF21_t *ret;
+void
+mk_DF21(struct ms_DF21_t *ret, const uint8_t *msg) {
 	uint16_t tmp;
 
-	ret = calloc(1, sizeof(struct ms_DF21_t));
-	
 	ret->DF = msg[0] >> 3;
 	ret->AP = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -56,8 +53,6 @@ mk_DF21(const uint8_t *msg) {
 	/* ID - Identity */
 	tmp = ((msg[2] << 8) | msg[3]) & 0x1FFF;
 	ret->ID = decode_ID(tmp);
-
-	return ret;
 }
 
 void
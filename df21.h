@@ -18,6 +18,7 @@
 #define _MS_DF21_H
 
 #include "fields.h"
+#include "aux.h"
 
 struct ms_DF21_t {
 	uint8_t DF;
@@ -25,11 +26,11 @@ struct ms_DF21_t {
 	uint8_t DR;
 	struct ms_UM_t UM;
 	uint16_t ID;
-	void *aux;
+	struct ms_aux_t aux;
 	uint32_t AP;
 };
 
-struct ms_DF21_t *mk_DF21(const uint8_t *msg);
+void mk_DF21(struct ms_DF21_t *ret, const uint8_t *msg);
 void pr_DF21(FILE *fp, struct ms_DF21_t *p, int);
 
 #endif
@@ -33,12 +33,8 @@
  *  0       1       2       3       4       5       6         11  13
  *
  */
-struct ms_DF24_t *
-mk_DF24(const uint8_t *msg) {
-	struct ms_DF24_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_DF24_t));
-	
+void
+mk_DF24(struct ms_DF24_t *ret, const uint8_t *msg) {
 	ret->DF = msg[0] >> 6;
 	ret->AP = (msg[11] << 16)
 	        | (msg[12] <<  8)
@@ -52,7 +48,6 @@ mk_DF24(const uint8_t *msg) {
 
 	/* MD - Message, Comm-D */
 	/*ret->MD = mk_MD(msg + 1);*/
-	return ret;
 }
 
 void
@@ -18,14 +18,15 @@
 #define _MS_DF24_H
 
 #include "fields.h"
+#include "aux.h"
 
 struct ms_DF24_t {
 	uint8_t DF;
 	bool KE;
 	uint8_t ND;
-	void *aux; /* MD */
+	struct ms_aux_t aux; /* MD */
 	uint32_t AP;
 };
-struct ms_DF24_t *mk_DF24(const uint8_t *msg);
+void mk_DF24(struct ms_DF24_t *ret, const uint8_t *msg);
 void pr_DF24(FILE *fp, struct ms_DF24_t *p, int);
 #endif
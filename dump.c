@@ -60,16 +60,25 @@ open_file(char *filename) {
 	return fp;
 }
 
+/*
+ * Writes a's history to its log. An aircraft may be retired,
+ * and seen again, several times, so the aircrafts already
+ * logged by this run are marked in logged, an address filter,
+ * and their logs appended to. Others' logs, as left by an
+ * earlier run, are truncated.
+ */
 int
-dump_flightlog(const struct ms_aircraft_t *a, const char *dir) {
-	const struct ms_ac_altitude_t *alt = a->altitudes.head;
-	const struct ms_ac_location_t *loc = a->locations.head;
-	const struct ms_ac_velocity_t *vel = a->velocities.head;
-	const struct ms_ac_squawk_t   *sqw = a->squawks.head;
+dump_flightlog(const struct ms_aircraft_t *a, const char *dir, uint8_t *logged) {
+	uint32_t addr = a->addr & 0x00FFFFFF;
+	const struct ms_ac_history_t *alt = &a->altitudes.h;
+	const struct ms_ac_history_t *loc = &a->locations.h;
+	const struct ms_ac_history_t *vel = &a->velocities.h;
+	const struct ms_ac_history_t *sqw = &a->squawks.h;
+	struct ms_ac_cursor_t c_alt, c_loc, c_vel, c_sqw;
 	char filename[PATH_MAX];
 	FILE *fp;
 
-	if (a->altitudes.n + a->locations.n + a->velocities.n + a->squawks.n == 0)
+	if (alt->n + loc->n + vel->n + sqw->n == 0)
 		return 0;
 
 	if (snprintf(filename, PATH_MAX - 1,
@@ -80,25 +89,33 @@ dump_flightlog(const struct ms_aircraft_t *a, const char *dir) {
 		return -1;
 	}
 
-	if (!(fp = fopen(filename, "w"))) {
+	if (!(fp = fopen(filename, logged[addr >> 3] & (1 << (addr & 7)) ? "a" : "w"))) {
 		perror("fopen");
 		return -1;
 	}
+	logged[addr >> 3] |= 1 << (addr & 7);
+
+	if (ftell(fp) == 0)
+		fputs("%Y-%m-%d %H:%M:%S\tID\tA (ft)\tv (kt)\th (°)\tlat\tlon\n", fp);
 
-	fputs("%Y-%m-%d %H:%M:%S\tID\tA (ft)\tv (kt)\th (°)\tlat\tlon\n", fp);
+	history_begin(alt, &c_alt);
+	history_begin(loc, &c_loc);
+	history_begin(vel, &c_vel);
+	history_begin(sqw, &c_sqw);
 
-	while (alt || loc || vel || sqw) {
+	while (c_alt.i < alt->n || c_loc.i < loc->n
+	    || c_vel.i < vel->n || c_sqw.i < sqw->n) {
 		time_t ts = 0;
 		char timestr[20];
 
-		if (alt)
-			ts = alt->time;
-		if (loc && (!ts || loc->time < ts))
-			ts = loc->time;
-		if (vel && (!ts || vel->time < ts))
-			ts = vel->time;
-		if (sqw && (!ts || sqw->time < ts))
-			ts = sqw->time;
+		if (c_alt.i < alt->n)
+			ts = c_alt.time;
+		if (c_loc.i < loc->n && (!ts || c_loc.time < ts))
+			ts = c_loc.time;
+		if (c_vel.i < vel->n && (!ts || c_vel.time < ts))
+			ts = c_vel.time;
+		if (c_sqw.i < sqw->n && (!ts || c_sqw.time < ts))
+			ts = c_sqw.time;
 
 		if (!ts)
 			break;
@@ -106,33 +123,35 @@ dump_flightlog(const struct ms_aircraft_t *a, const char *dir) {
 		strftime(timestr, 20, "%Y-%m-%d %H:%M:%S", localtime(&ts));
 		fprintf(fp, "%s\t", timestr);
 
-		if (sqw && sqw->time == ts) {
-			fprintf(fp, "%04o\t", sqw->ID);
-			sqw = sqw->next;
+		if (c_sqw.i < sqw->n && c_sqw.time == ts) {
+			fprintf(fp, "%04o\t", a->squawks.ID[c_sqw.slot]);
+			history_next(sqw, &c_sqw);
 		} else {
 			fprintf(fp, "-\t");
 		}
 
-		if (alt && alt->time == ts) {
-			fprintf(fp, "%.0f\t", alt->alt);
-			while (alt && alt->time == ts)
-				alt = alt->next;
+		if (c_alt.i < alt->n && c_alt.time == ts) {
+			fprintf(fp, "%d\t", a->altitudes.alt[c_alt.slot]);
+			while (c_alt.i < alt->n && c_alt.time == ts)
+				history_next(alt, &c_alt);
 		} else {
 			fprintf(fp, "-\t");
 		}
 
-		if (vel && vel->time == ts) {
-			fprintf(fp, "%.0f\t%.0f\t", vel->speed, vel->heading);
-			while (vel && vel->time == ts)
-				vel = vel->next;
+		if (c_vel.i < vel->n && c_vel.time == ts) {
+			fprintf(fp, "%.0f\t%.0f\t", a->velocities.speed[c_vel.slot],
+			        a->velocities.heading[c_vel.slot]);
+			while (c_vel.i < vel->n && c_vel.time == ts)
+				history_next(vel, &c_vel);
 		} else {
 			fprintf(fp, "-\t-\t");
 		}
 
-		if (loc && loc->time == ts) {
-			fprintf(fp, "%.4f\t%.4f\n", loc->lat, loc->lon);
-			while (loc && loc->time == ts)
-				loc = loc->next;
+		if (c_loc.i < loc->n && c_loc.time == ts) {
+			fprintf(fp, "%.4f\t%.4f\n", a->locations.lat[c_loc.slot],
+			        a->locations.lon[c_loc.slot]);
+			while (c_loc.i < loc->n && c_loc.time == ts)
+				history_next(loc, &c_loc);
 		} else {
 			fprintf(fp, "-\t-\n");
 		}
@@ -145,9 +164,9 @@ dump_flightlog(const struct ms_aircraft_t *a, const char *dir) {
 }
 
 int
-dump_messages(const struct ms_msg_t *msgs, const char *dir) {
+dump_messages(struct ms_msg_t *msgs, const char *dir) {
 	char filename[PATH_MAX];
-	const struct ms_msg_t *msg;
+	struct ms_msg_t *msg;
 	FILE *fp;
 
 
@@ -309,6 +328,8 @@ dump_stats(const char *filename, const struct ms_stats_t *s) {
 	fprintf(fp, "msgs:%lu\n", s->n_msgs);
 	fprintf(fp, "aircrafts:%lu\n", s->n_acs);
 	fprintf(fp, "nations:%lu\n", s->n_nats);
+	if (s->n_dups)
+		fprintf(fp, "duplicates:%lu\n", s->n_dups);
 
 #define PRDF(N) do { fprintf(fp, "df%d:%lu\n", N, s->n_dfs[N]); } while(0)
 	PRDF(0); PRDF(4); PRDF(5);
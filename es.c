@@ -20,13 +20,7 @@
 #include <stdio.h>
 
 #include "es.h"
-#include "bds_05.h"
-#include "bds_06.h"
-#include "bds_08.h"
-#include "bds_09.h"
-#include "bds_61.h"
-#include "bds_62.h"
-#include "bds_65.h"
+#include "aux.h"
 
 void
 mk_ES_TYPE(struct ms_ES_TYPE_t *et, uint8_t first_byte) {
@@ -109,32 +103,48 @@ mk_ES_TYPE(struct ms_ES_TYPE_t *et, uint8_t first_byte) {
 	}
 }
 
-void *
-mk_extended_squitter(const uint8_t *msg, enum ms_extended_squitter_t es_type) {
-
+void
+mk_extended_squitter(struct ms_aux_t *aux, const uint8_t *msg,
+                     enum ms_extended_squitter_t es_type) {
 	switch (es_type) {
 	case ES_AIRBORNE_POSITION:
-		return mk_BDS_05(msg);
+		mk_BDS_05(&aux->u.BDS_05, msg);
+		aux->type = AUX_BDS_05;
+		break;
 	case ES_IDENTIFICATION:
-		return mk_BDS_08(msg);
+		mk_BDS_08(&aux->u.BDS_08, msg);
+		aux->type = AUX_BDS_08;
+		break;
 	case ES_SURFACE_POSITION:
-		return mk_BDS_06(msg);
+		mk_BDS_06(&aux->u.BDS_06, msg);
+		aux->type = AUX_BDS_06;
+		break;
 	case ES_AIRBORNE_VELOCITY:
-		return mk_BDS_09(msg);
+		mk_BDS_09(&aux->u.BDS_09, msg);
+		aux->type = AUX_BDS_09;
+		break;
 	case ES_EMERGENCY:
-		return mk_BDS_61_1(msg);
+		mk_BDS_61_1(&aux->u.BDS_61_1, msg);
+		aux->type = AUX_BDS_61_1;
+		break;
 	case ES_ACAS_RA_BROADCAST:
-		return mk_BDS_61_2(msg);
+		mk_BDS_61_2(&aux->u.BDS_30, msg);
+		aux->type = AUX_BDS_30;
+		break;
 	case ES_TARGET_STATE:
-		return mk_BDS_62(msg);
+		mk_BDS_62(&aux->u.BDS_62, msg);
+		aux->type = AUX_BDS_62;
+		break;
 	case ES_OPERATIONAL_STATUS:
-		return mk_BDS_65(msg);
+		mk_BDS_65(&aux->u.BDS_65, msg);
+		aux->type = AUX_BDS_65;
+		break;
 	case ES_NATIONAL_USE:
 	case ES_TEST_MESSAGE:
 	case ES_RESERVED:
-		return NULL;
+		aux->type = AUX_NONE;
+		break;
 	}
-	return NULL;
 }
 
 bool
@@ -184,31 +194,31 @@ df18_IMF(const uint8_t *msg) {
 }
 
 void
-pr_extended_squitter(FILE *fp, const void *p, const struct ms_ES_TYPE_t *et, int v) {
+pr_extended_squitter(FILE *fp, const struct ms_aux_t *aux, const struct ms_ES_TYPE_t *et, int v) {
 	switch (et->et) {
 	case ES_AIRBORNE_POSITION:
-		pr_BDS_05(fp, p, v);
+		pr_BDS_05(fp, &aux->u.BDS_05, v);
 		break;
 	case ES_IDENTIFICATION:
-		pr_BDS_08(fp, p, v);
+		pr_BDS_08(fp, &aux->u.BDS_08, v);
 		break;
 	case ES_SURFACE_POSITION:
-		pr_BDS_06(fp, p, v);
+		pr_BDS_06(fp, &aux->u.BDS_06, v);
 		break;
 	case ES_AIRBORNE_VELOCITY:
-		pr_BDS_09(fp, p, v);
+		pr_BDS_09(fp, &aux->u.BDS_09, v);
 		break;
 	case ES_EMERGENCY:
-		pr_BDS_61_1(fp, p, v);
+		pr_BDS_61_1(fp, &aux->u.BDS_61_1, v);
 		break;
 	case ES_ACAS_RA_BROADCAST:
-		pr_BDS_61_2(fp, p, v);
+		pr_BDS_61_2(fp, &aux->u.BDS_30, v);
 		break;
 	case ES_TARGET_STATE:
-		pr_BDS_62(fp, p, v);
+		pr_BDS_62(fp, &aux->u.BDS_62, v);
 		break;
 	case ES_OPERATIONAL_STATUS:
-		pr_BDS_65(fp, p, v);
+		pr_BDS_65(fp, &aux->u.BDS_65, v);
 		break;
 	case ES_NATIONAL_USE:
 		fprintf(fp, "ES=%d,%d:National use:TODO\n", et->tc, et->st);
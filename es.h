@@ -40,7 +40,11 @@ struct ms_ES_TYPE_t {
 };
 
 void mk_ES_TYPE(struct ms_ES_TYPE_t *et, uint8_t first_byte);
-void *mk_extended_squitter(const uint8_t *msg, enum ms_extended_squitter_t es_type);
-void pr_extended_squitter(FILE *fp, const void *p, const struct ms_ES_TYPE_t *et, int v);
+struct ms_aux_t;
+
+void mk_extended_squitter(struct ms_aux_t *aux, const uint8_t *msg,
+                          enum ms_extended_squitter_t es_type);
+void pr_extended_squitter(FILE *fp, const struct ms_aux_t *aux,
+                          const struct ms_ES_TYPE_t *et, int v);
 bool df18_IMF(const uint8_t *msg);
 #endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hex.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define HEX_SIMD
+#include <immintrin.h>
+#endif
+
+/*
+ * Conversion of hexadecimal strings, such as message data, to bytes.
+ * All variants validate and convert 2n characters from src into
+ * n bytes at dst, reading nothing beyond src[2n - 1], and return -1
+ * if any of the characters isn't a hexadecimal digit.
+ */
+
+static const uint8_t hexval[256] = {
+	['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13,
+	['4'] = 0x14, ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17,
+	['8'] = 0x18, ['9'] = 0x19,
+	['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C,
+	['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+	['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C,
+	['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+};
+
+static int
+hex_generic(const char *src, uint8_t *dst, size_t n) {
+	const uint8_t *s = (const uint8_t *)src;
+	size_t i;
+
+	for (i = 0; i < n; ++i) {
+		uint8_t a = hexval[*s++];
+		uint8_t b = hexval[*s++];
+
+		/* High nibble set for valid digits */
+		if (!(a & b & 0x10))
+			return -1;
+
+		dst[i] = (a << 4) | (b & 0x0F);
+	}
+	return 0;
+}
+
+#ifdef HEX_SIMD
+/*
+ * Sixteen characters into eight bytes, in the low half
+ * of the returned vector. *valid gets a bit per digit.
+ */
+static __m128i
+hex16_sse2(__m128i c, int *valid) {
+	__m128i lc, dig, alp, nib, w;
+
+	lc  = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	dig = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+	                    _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+	alp = _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)),
+	                    _mm_cmplt_epi8(lc, _mm_set1_epi8('f' + 1)));
+
+	*valid = _mm_movemask_epi8(_mm_or_si128(dig, alp));
+
+	nib = _mm_or_si128(_mm_and_si128(dig, _mm_sub_epi8(c,  _mm_set1_epi8('0'))),
+	                   _mm_and_si128(alp, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+
+	/* Pairs of nibbles, first one high, into 16 bit words */
+	w = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nib, _mm_set1_epi16(0x00FF)), 4),
+	                 _mm_srli_epi16(nib, 8));
+
+	return _mm_packus_epi16(w, w);
+}
+
+static int
+hex_sse2(const char *src, uint8_t *dst, size_t n) {
+	char pad[16];
+	int valid;
+	size_t i;
+
+	if (n < 8) {
+		/* Short messages: 14 characters */
+		memset(pad, '0', 16);
+		memcpy(pad, src, 2 * n);
+		_mm_storel_epi64((__m128i *)pad,
+		                 hex16_sse2(_mm_loadu_si128((const __m128i *)pad), &valid));
+		memcpy(dst, pad, n);
+		return valid == 0xFFFF ? 0 : -1;
+	}
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		_mm_storel_epi64((__m128i *)(dst + i),
+		                 hex16_sse2(_mm_loadu_si128((const __m128i *)(src + 2 * i)), &valid));
+		if (valid != 0xFFFF)
+			return -1;
+	}
+
+	/*
+	 * Remainder, e.g. the last 12 characters of long
+	 * messages, overlapping what's already been done.
+	 */
+	if (i < n) {
+		i = n - 8;
+		_mm_storel_epi64((__m128i *)(dst + i),
+		                 hex16_sse2(_mm_loadu_si128((const __m128i *)(src + 2 * i)), &valid));
+		if (valid != 0xFFFF)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Long messages, 28 characters, are loaded as seven
+ * masked doublewords, never touching the four bytes
+ * beyond them.
+ */
+__attribute__((target("avx2")))
+static int
+hex_avx2(const char *src, uint8_t *dst, size_t n) {
+	__m256i c, lc, dig, alp, nib, w;
+	uint8_t out[32];
+	int valid;
+
+	if (n != 14)
+		return hex_sse2(src, dst, n);
+
+	c = _mm256_maskload_epi32((const int *)src,
+	                          _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, -1, 0));
+
+	lc  = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+	dig = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+	                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+	alp = _mm256_and_si256(_mm256_cmpgt_epi8(lc, _mm256_set1_epi8('a' - 1)),
+	                       _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lc));
+
+	valid = _mm256_movemask_epi8(_mm256_or_si256(dig, alp));
+
+	nib = _mm256_or_si256(_mm256_and_si256(dig, _mm256_sub_epi8(c,  _mm256_set1_epi8('0'))),
+	                      _mm256_and_si256(alp, _mm256_sub_epi8(lc, _mm256_set1_epi8('a' - 10))));
+	w = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nib, _mm256_set1_epi16(0x00FF)), 4),
+	                    _mm256_srli_epi16(nib, 8));
+
+	/* Pack works within lanes, gather the two low quadwords */
+	w = _mm256_permute4x64_epi64(_mm256_packus_epi16(w, w), 0x08);
+	_mm256_storeu_si256((__m256i *)out, w);
+	memcpy(dst, out, 14);
+
+	return (valid & 0x0FFFFFFF) == 0x0FFFFFFF ? 0 : -1;
+}
+#endif
+
+static int hex_dispatch(const char *src, uint8_t *dst, size_t n);
+static int (*hex_impl)(const char *, uint8_t *, size_t) = hex_dispatch;
+
+/*
+ * Pick the best implementation on first use.
+ */
+static int
+hex_dispatch(const char *src, uint8_t *dst, size_t n) {
+#ifdef HEX_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		hex_impl = hex_avx2;
+	else
+		hex_impl = hex_sse2;
+#else
+	hex_impl = hex_generic;
+#endif
+	return hex_impl(src, dst, n);
+}
+
+int
+hex_to_bytes(const char *src, uint8_t *dst, size_t n) {
+	if (n < 4)
+		return hex_generic(src, dst, n);
+	return hex_impl(src, dst, n);
+}
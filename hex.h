@@ -0,0 +1,8 @@
+#ifndef _MS_HEX_H
+#define _MS_HEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+int hex_to_bytes(const char *src, uint8_t *dst, size_t n);
+#endif
@@ -189,7 +189,7 @@ update_histogram(struct ms_histogram_t *h, const struct ms_msg_t *msgs) {
 
 
 			for (i = 0; i < h->n_acs; ++i) {
-				if (h->acs[i] == msg->aircraft) {
+				if (h->acs[i] == msg->aircraft->addr) {
 					new_ac = false;
 					break;
 				}
@@ -197,9 +197,9 @@ update_histogram(struct ms_histogram_t *h, const struct ms_msg_t *msgs) {
 			if (new_ac) {
 				if (h->n_acs == h->acs_size) {
 					h->acs_size += 100;
-					h->acs = realloc(h->acs, h->acs_size * sizeof(struct ms_aircraft_t*));
+					h->acs = realloc(h->acs, h->acs_size * sizeof(uint32_t));
 				}
-				h->acs[h->n_acs++] = msg->aircraft;
+				h->acs[h->n_acs++] = msg->aircraft->addr;
 			}
 
 
@@ -228,7 +228,7 @@ update_histogram(struct ms_histogram_t *h, const struct ms_msg_t *msgs) {
 				free(h->nats);
 			}
 			h->nats = malloc(h->nats_size * sizeof(struct ms_nation_t*));
-			h->acs  = malloc(h->acs_size  * sizeof(struct ms_aircraft_t*));
+			h->acs  = malloc(h->acs_size  * sizeof(uint32_t));
 			
 			h->n_nats = 0;
 			h->n_acs = 0;
@@ -8,7 +8,6 @@
 
 struct ms_msg_t;
 struct ms_nation_t;
-struct ms_aircraft_t;
 
 struct ms_histogram_t {
 	FILE *fp;
@@ -22,7 +21,7 @@ struct ms_histogram_t {
 	struct ms_nation_t const **nats;
 	size_t n_acs;
 	size_t acs_size;
-	struct ms_aircraft_t const **acs;
+	uint32_t *acs; /* addresses, as aircrafts may be retired */
 };
 
 void destroy_histogram(struct ms_histogram_t *);
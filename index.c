@@ -0,0 +1,345 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+
+#include "index.h"
+#include "reader.h"
+#include "parse.h"
+
+/*
+ * The index has an entry for each minute in which the time of the
+ * input moves past what has been seen so far, pointing at the first
+ * message of that minute. For input in (roughly) chronological order,
+ * everything before an entry is older than its minute, and everything
+ * after it is at least as new.
+ */
+
+static void
+put32(uint8_t *p, uint32_t x) {
+	p[0] = x >>  0;
+	p[1] = x >>  8;
+	p[2] = x >> 16;
+	p[3] = x >> 24;
+}
+
+static uint32_t
+get32(const uint8_t *p) {
+	return ((uint32_t)p[0] <<  0)
+	     | ((uint32_t)p[1] <<  8)
+	     | ((uint32_t)p[2] << 16)
+	     | ((uint32_t)p[3] << 24);
+}
+
+static void
+put64(uint8_t *p, int64_t x) {
+	put32(p, (uint64_t)x);
+	put32(p + 4, (uint64_t)x >> 32);
+}
+
+static int64_t
+get64(const uint8_t *p) {
+	return get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+static char *
+index_filename(const char *filename) {
+	char *s = malloc(strlen(filename) + sizeof(INDEX_SUFFIX));
+
+	strcpy(s, filename);
+	strcat(s, INDEX_SUFFIX);
+	return s;
+}
+
+static void
+add_entry(struct ms_index_t *idx, time_t time, off_t offset) {
+	if (!idx->n || !(idx->n & (idx->n - 1)))
+		idx->entries = realloc(idx->entries, (idx->n ? 2 * idx->n : 1)
+		                       * sizeof(struct ms_index_entry_t));
+	idx->entries[idx->n].time = time;
+	idx->entries[idx->n].offset = offset;
+	idx->n += 1;
+}
+
+/*
+ * Returns NULL if there is no index, or if it's damaged.
+ */
+struct ms_index_t *
+load_index(const char *filename) {
+	struct ms_index_t *idx;
+	uint8_t buf[INDEX_HDRLEN];
+	char *fn;
+	FILE *fp;
+
+	fn = index_filename(filename);
+	fp = fopen(fn, "rb");
+	free(fn);
+	if (!fp)
+		return NULL;
+
+	if (fread(buf, INDEX_HDRLEN, 1, fp) != 1
+	 || memcmp(buf, INDEX_MAGIC, 8)
+	 || get32(buf + 8) != INDEX_VERSION) {
+		fclose(fp);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	idx = calloc(1, sizeof(struct ms_index_t));
+	idx->format = get32(buf + 12);
+	idx->size = get64(buf + 16);
+	idx->mtime = get64(buf + 24);
+	idx->dev = get64(buf + 32);
+	idx->ino = get64(buf + 40);
+
+	while (fread(buf, INDEX_ENTLEN, 1, fp) == 1)
+		add_entry(idx, get64(buf), get64(buf + 8));
+
+	fclose(fp);
+	return idx;
+}
+
+/*
+ * Written aside and renamed into place, so that
+ * a reader never sees half an index.
+ */
+int
+save_index(const char *filename, const struct ms_index_t *idx) {
+	uint8_t buf[INDEX_HDRLEN];
+	char *fn, *tmp;
+	FILE *fp;
+	size_t i;
+	int err = 0;
+
+	fn = index_filename(filename);
+	tmp = malloc(strlen(fn) + 5);
+	sprintf(tmp, "%s.tmp", fn);
+
+	if (!(fp = fopen(tmp, "wb"))) {
+		free(tmp);
+		free(fn);
+		return -1;
+	}
+
+	memset(buf, 0, sizeof(buf));
+	memcpy(buf, INDEX_MAGIC, 8);
+	put32(buf + 8, INDEX_VERSION);
+	put32(buf + 12, idx->format);
+	put64(buf + 16, idx->size);
+	put64(buf + 24, idx->mtime);
+	put64(buf + 32, idx->dev);
+	put64(buf + 40, idx->ino);
+	if (fwrite(buf, INDEX_HDRLEN, 1, fp) != 1)
+		err = -1;
+
+	for (i = 0; !err && i < idx->n; ++i) {
+		put64(buf, idx->entries[i].time);
+		put64(buf + 8, idx->entries[i].offset);
+		if (fwrite(buf, INDEX_ENTLEN, 1, fp) != 1)
+			err = -1;
+	}
+
+	if (fclose(fp) != 0)
+		err = -1;
+	if (!err && rename(tmp, fn) < 0)
+		err = -1;
+	if (err)
+		remove(tmp);
+
+	free(tmp);
+	free(fn);
+	return err;
+}
+
+/*
+ * Reads the file from the last entry of idx on,
+ * adding entries for what's been appended since.
+ */
+static int
+scan_file(const char *filename, struct ms_index_t *idx) {
+	struct ms_frame_t frame;
+	struct ms_reader_t *r;
+	time_t last = 0;
+	off_t offset = 0;
+	size_t count = 0;
+	bool timed = true;
+
+	if (idx->n) {
+		idx->n -= 1;
+		offset = idx->entries[idx->n].offset;
+		if (idx->n)
+			last = idx->entries[idx->n - 1].time;
+	}
+
+	if (!(r = mk_reader(filename, offset)))
+		return -1;
+	if (offset)
+		r->format = idx->format;
+
+	for (;;) {
+		off_t pos = reader_offset(r);
+		time_t minute;
+
+		if (read_frame(r, &frame) <= 0)
+			break;
+
+		/*
+		 * Times taken from the MLAT clock are
+		 * relative to when the file is read.
+		 */
+		if (r->time_base) {
+			timed = false;
+			break;
+		}
+
+		/*
+		 * The header of an archive is read along
+		 * with its first record.
+		 */
+		if (!idx->n)
+			pos = 0;
+
+		minute = frame.time - frame.time % 60;
+		if (!idx->n || minute > last) {
+			add_entry(idx, minute, pos);
+			last = minute;
+		}
+
+		if (++count % 65536 == 0)
+			discard_read(r);
+	}
+
+	idx->format = r->format;
+	if (destroy_reader(r) < 0)
+		return -1;
+
+	if (!timed) {
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Returns an index of filename that's up to date, from its
+ * index file if there is one, and otherwise by reading it,
+ * after which the index file is written if possible. Only
+ * what's been appended to the file is read, if it has grown.
+ * A file replaced by another, as when rotated, is told by its
+ * inode, even if it has the same size and time as the last.
+ */
+struct ms_index_t *
+update_index(const char *filename) {
+	struct ms_index_t *idx;
+	struct stat st;
+
+	if (stat(filename, &st) < 0)
+		return NULL;
+
+	if ((idx = load_index(filename))) {
+		bool same = idx->dev == st.st_dev && idx->ino == st.st_ino;
+
+		if (same && idx->size == st.st_size && idx->mtime == st.st_mtime)
+			return idx;
+		if (!same || idx->size > st.st_size)
+			idx->n = 0;
+	} else {
+		idx = calloc(1, sizeof(struct ms_index_t));
+	}
+
+	/*
+	 * Inputs without time of their own can't be indexed.
+	 */
+	if (scan_file(filename, idx) < 0) {
+		destroy_index(idx);
+		return NULL;
+	}
+
+	idx->size = st.st_size;
+	idx->mtime = st.st_mtime;
+	idx->dev = st.st_dev;
+	idx->ino = st.st_ino;
+	save_index(filename, idx);
+
+	return idx;
+}
+
+/*
+ * Offset of the first message that may be at or after from.
+ */
+off_t
+index_start(const struct ms_index_t *idx, time_t from) {
+	size_t lo = 0;
+	size_t hi = idx->n;
+
+	from -= from % 60;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (idx->entries[mid].time < from)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/*
+	 * Only the last minute may be left.
+	 */
+	if (lo == idx->n)
+		lo = idx->n ? idx->n - 1 : 0;
+	return idx->n ? idx->entries[lo].offset : 0;
+}
+
+/*
+ * Offset past the last message that may be before to,
+ * or 0 if they may be read up to the end of the file.
+ * Input is taken to be in order of time, give or take a
+ * minute, as when merged from several receivers, so the
+ * end is a minute past to. Messages that are later still
+ * are missed.
+ */
+off_t
+index_end(const struct ms_index_t *idx, time_t to) {
+	size_t lo = 0;
+	size_t hi = idx->n;
+
+	to += 60;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (idx->entries[mid].time < to)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == idx->n)
+		return 0;
+	return idx->entries[lo].offset;
+}
+
+void
+destroy_index(struct ms_index_t *idx) {
+	free(idx->entries);
+	free(idx);
+}
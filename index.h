@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_INDEX_H
+#define _MS_INDEX_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "reader.h"
+
+/*
+ * Time index file layout, all integers little endian.
+ * The index of a file is kept next to it, with INDEX_SUFFIX.
+ *
+ *  header, INDEX_HDRLEN bytes
+ *    0  magic, INDEX_MAGIC
+ *    8  u32 version
+ *   12  u32 format of the indexed file
+ *   16  s64 size of the indexed file
+ *   24  s64 modification time of the indexed file
+ *   32  u64 device of the indexed file
+ *   40  u64 inode of the indexed file
+ *
+ *  followed by entries, INDEX_ENTLEN bytes each
+ *    0  s64 time, at the start of a minute
+ *    8  s64 offset of the first message of that minute
+ */
+#define INDEX_MAGIC    "\211MSINDX\n"
+#define INDEX_SUFFIX   ".idx"
+#define INDEX_VERSION  2
+#define INDEX_HDRLEN   48
+#define INDEX_ENTLEN   16
+
+struct ms_index_entry_t {
+	time_t time;
+	off_t offset;
+};
+
+struct ms_index_t {
+	enum ms_format_t format;
+	off_t size;
+	time_t mtime;
+	dev_t dev;
+	ino_t ino;
+	size_t n;
+	struct ms_index_entry_t *entries;
+};
+
+struct ms_index_t *load_index(const char *filename);
+struct ms_index_t *update_index(const char *filename);
+int save_index(const char *filename, const struct ms_index_t *idx);
+off_t index_start(const struct ms_index_t *idx, time_t from);
+off_t index_end(const struct ms_index_t *idx, time_t to);
+void destroy_index(struct ms_index_t *idx);
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+
+#include "merge.h"
+#include "reader.h"
+#include "parse.h"
+
+/*
+ * The readers are merged by the time of their messages, with
+ * a binary min-heap of the readers' next frames. Messages of
+ * the same second are taken from the readers in the order
+ * they were given, and each reader's own order is kept.
+ */
+struct ms_merge_t {
+	size_t n;
+	struct ms_reader_t **readers;
+	struct ms_frame_t *frames;
+	size_t *heap;
+	size_t len;
+	bool primed;
+};
+
+static bool
+before(const struct ms_merge_t *m, size_t a, size_t b) {
+	if (m->frames[a].time != m->frames[b].time)
+		return m->frames[a].time < m->frames[b].time;
+	return a < b;
+}
+
+static void
+sift_down(struct ms_merge_t *m, size_t i) {
+	for (;;) {
+		size_t l = 2 * i + 1;
+		size_t r = l + 1;
+		size_t min = i;
+		size_t tmp;
+
+		if (l < m->len && before(m, m->heap[l], m->heap[min]))
+			min = l;
+		if (r < m->len && before(m, m->heap[r], m->heap[min]))
+			min = r;
+		if (min == i)
+			return;
+
+		tmp = m->heap[i];
+		m->heap[i] = m->heap[min];
+		m->heap[min] = tmp;
+		i = min;
+	}
+}
+
+/*
+ * Takes over the readers, which are destroyed along with
+ * the returned reader. Messages are read from it with
+ * read_frame() and parse_reader(), as from any other.
+ */
+struct ms_reader_t *
+mk_merger(struct ms_reader_t **readers, size_t n) {
+	struct ms_reader_t *r;
+	struct ms_merge_t *m;
+	size_t i;
+
+	m = calloc(1, sizeof(struct ms_merge_t));
+	m->n = n;
+	m->readers = malloc(n * sizeof(struct ms_reader_t *));
+	m->frames = malloc(n * sizeof(struct ms_frame_t));
+	m->heap = malloc(n * sizeof(size_t));
+	for (i = 0; i < n; ++i)
+		m->readers[i] = readers[i];
+
+	r = calloc(1, sizeof(struct ms_reader_t));
+	r->format = FORMAT_MERGED;
+	r->merge = m;
+	r->buf = "";
+
+	return r;
+}
+
+/*
+ * The offset of a merger is the total of
+ * what has been read by all its readers.
+ */
+static off_t
+merged_offset(const struct ms_merge_t *m) {
+	off_t offset = 0;
+	size_t i;
+
+	for (i = 0; i < m->n; ++i)
+		offset += reader_offset(m->readers[i]);
+	return offset;
+}
+
+int
+read_merged(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	struct ms_merge_t *m = r->merge;
+	size_t i;
+
+	if (!m->primed) {
+		for (i = 0; i < m->n; ++i)
+			if (read_frame(m->readers[i], &m->frames[i]) > 0)
+				m->heap[m->len++] = i;
+		for (i = m->len / 2; i-- > 0; )
+			sift_down(m, i);
+		m->primed = true;
+	}
+
+	if (!m->len)
+		return 0;
+
+	i = m->heap[0];
+	*frame = m->frames[i];
+
+	if (read_frame(m->readers[i], &m->frames[i]) <= 0)
+		m->heap[0] = m->heap[--m->len];
+	sift_down(m, 0);
+
+	r->offset = merged_offset(m);
+	return 1;
+}
+
+void
+discard_merged(struct ms_merge_t *m) {
+	size_t i;
+
+	for (i = 0; i < m->n; ++i)
+		discard_read(m->readers[i]);
+}
+
+/*
+ * Returns -1 if any of the inputs failed, see destroy_reader.
+ */
+int
+destroy_merge(struct ms_merge_t *m) {
+	int ret = 0;
+	size_t i;
+
+	for (i = 0; i < m->n; ++i)
+		if (destroy_reader(m->readers[i]) < 0)
+			ret = -1;
+	free(m->readers);
+	free(m->frames);
+	free(m->heap);
+	free(m);
+
+	if (ret < 0)
+		errno = EIO;
+	return ret;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_MERGE_H
+#define _MS_MERGE_H
+
+#include <sys/types.h>
+
+struct ms_reader_t;
+struct ms_frame_t;
+struct ms_merge_t;
+
+struct ms_reader_t *mk_merger(struct ms_reader_t **readers, size_t n);
+int read_merged(struct ms_reader_t *r, struct ms_frame_t *frame);
+void discard_merged(struct ms_merge_t *m);
+int destroy_merge(struct ms_merge_t *m);
+
+#endif
@@ -26,16 +26,41 @@
 #include "crc.h"
 #include "nation.h"
 #include "compass.h"
+#include "arena.h"
 
 #define CONF_MSG_TTL
 #include "config.h"
 
+/*
+ * addr is 0xFF000000 if it isn't known, when it's taken
+ * from the AA field, or from the AP field of the syndrome.
+ */
 struct ms_msg_t *
 mk_msg(uint8_t *msg, time_t tme, uint32_t addr) {
+	return mk_msg_syn(msg, tme, addr, 0xFF000000);
+}
+
+/*
+ * As mk_msg, but with the syndrome already known, e.g. from
+ * an archive. It is computed if syn is 0xFF000000.
+ */
+struct ms_msg_t *
+mk_msg_syn(uint8_t *msg, time_t tme, uint32_t addr, uint32_t syn) {
+	return mk_msg_arena(NULL, msg, tme, addr, syn);
+}
+
+/*
+ * As mk_msg_syn, but the message, and later its payload, is
+ * allocated from arena, which it holds until destroyed.
+ */
+struct ms_msg_t *
+mk_msg_arena(struct ms_arena_t *arena, uint8_t *msg, time_t tme, uint32_t addr, uint32_t syn) {
 	struct ms_msg_t *ret;
 	size_t i;
 
-	ret = calloc(1, sizeof(struct ms_msg_t));
+	ret = arena_alloc(arena, sizeof(struct ms_msg_t));
+	if (arena)
+		ret->arena = hold_arena(arena);
 
 	/*
 	 * [1] Figure-3.7 Note 3, DF24 is any
@@ -55,17 +80,21 @@ mk_msg(uint8_t *msg, time_t tme, uint32_t addr) {
 	else
 		ret->len = 7;
 	
-	ret->raw = calloc(ret->len, sizeof(uint8_t));
 	for (i = 0; i < ret->len; ++i)
 		ret->raw[i] = msg[i];
 
-	ret->cksum.crc = checksum(ret->raw, ret->len);
 	ret->cksum.AP  = (ret->raw[ret->len - 3] << 16)
 		       | (ret->raw[ret->len - 2] <<  8)
 		       | (ret->raw[ret->len - 1] <<  0);
-	ret->cksum.syn = ret->cksum.crc ^ ret->cksum.AP;
+	if (syn & 0xFF000000) {
+		ret->cksum.crc = checksum(ret->raw, ret->len);
+		ret->cksum.syn = ret->cksum.crc ^ ret->cksum.AP;
+	} else {
+		ret->cksum.syn = syn;
+		ret->cksum.crc = syn ^ ret->cksum.AP;
+	}
 
-	if (addr & 0x00FFFFFF) {
+	if (!(addr & 0xFF000000)) {
 		ret->addr = addr;
 		/* TODO ... */
 		if (ret->DF == 20 || ret->DF == 21) {
@@ -100,8 +129,39 @@ mk_msg(uint8_t *msg, time_t tme, uint32_t addr) {
 
 	}
 
-#define MKDF(X, NN) case X: ret->msg = mk_DF ## NN (ret->raw); break; 
-	switch (ret->DF) {
+	ret->ext = NULL;
+	return ret;
+
+}
+
+/*
+ * The DF specific part of the message is decoded when
+ * first asked for, so that messages that are only
+ * counted never are. It's allocated from the message's
+ * arena, if it's in one, else on its own. Returns NULL
+ * for unknown DFs, or if it can't be allocated.
+ */
+union ms_payload_t *
+decode_msg(struct ms_msg_t *msg) {
+	union ms_payload_t *p;
+
+	if (msg->payload)
+		return msg->payload;
+
+	switch (msg->DF) {
+	case 0: case 4: case 5: case 11: case 16: case 17:
+	case 18: case 19: case 20: case 21: case 24:
+		break;
+	default:
+		return NULL;
+	}
+
+	/* The payload is zeroed as it's allocated */
+	if (!(p = arena_alloc(msg->arena, sizeof(union ms_payload_t))))
+		return NULL;
+
+#define MKDF(X, NN) case X: mk_DF ## NN (&p->DF ## NN, msg->raw); break;
+	switch (msg->DF) {
 	MKDF( 0, 00)
 	MKDF( 4, 04)
 	MKDF( 5, 05)
@@ -114,15 +174,19 @@ mk_msg(uint8_t *msg, time_t tme, uint32_t addr) {
 	MKDF(21, 21)
 	MKDF(24, 24)
 	}
+#undef MKDF
 
-	ret->ext = NULL;
-	return ret;
-
+	msg->payload = p;
+	return p;
 }
 
+/*
+ * Decodes msg first, if it isn't yet, see decode_msg.
+ */
 void
-pr_msg(FILE *fp, const struct ms_msg_t *msg, int v) {
+pr_msg(FILE *fp, struct ms_msg_t *msg, int v) {
 	struct ms_aircraft_t *a = msg->aircraft;
+	union ms_payload_t *p = decode_msg(msg);
 	char timestr[20];
 	struct tm *tmp;
 	size_t i;
@@ -157,38 +221,45 @@ pr_msg(FILE *fp, const struct ms_msg_t *msg, int v) {
 	}
 
 	if (a) {
-		if (a->locations.last && msg->time - a->locations.last->time < location_ttl) {
+		const struct ms_ac_locations_t *l = &a->locations;
+		const struct ms_ac_altitudes_t *alts = &a->altitudes;
+		const struct ms_ac_velocities_t *vel = &a->velocities;
+		const struct ms_ac_squawks_t *sqw = &a->squawks;
+
+		if (l->h.n && msg->time - l->h.last < location_ttl) {
+			double lat = l->lat[history_last(&l->h)];
+			double lon = l->lon[history_last(&l->h)];
 			char s_lat[40];
 			char s_lon[40];
-			fill_angle_str(s_lat, 40, a->locations.last->lat);
-			fill_angle_str(s_lon, 40, a->locations.last->lon);
+			fill_angle_str(s_lat, 40, lat);
+			fill_angle_str(s_lon, 40, lon);
 			fprintf(fp, "Location:%s%c %s%c\n",
-			       s_lat, a->locations.last->lat < 0 ? 'S' : 'N',
-			       s_lon, a->locations.last->lon < 0 ? 'W' : 'E');
+			       s_lat, lat < 0 ? 'S' : 'N',
+			       s_lon, lon < 0 ? 'W' : 'E');
 		}
-		if (a->altitudes.last && msg->time - a->altitudes.last->time < altitude_ttl) {
-			double alt = a->altitudes.last->alt;
+		if (alts->h.n && msg->time - alts->h.last < altitude_ttl) {
+			double alt = alts->alt[history_last(&alts->h)];
 			fprintf(fp, "Altitude:%'.0f ft (%'.0f m)\n",
 			        alt, FT2METRES(alt));
 		}
-		if (a->velocities.last && msg->time - a->velocities.last->time < velocity_ttl) {
+		if (vel->h.n && msg->time - vel->h.last < velocity_ttl) {
 			char angle[40];
 			double s, h;
-			s = a->velocities.last->speed;
-			h = a->velocities.last->heading;
+			s = vel->speed[history_last(&vel->h)];
+			h = vel->heading[history_last(&vel->h)];
 
 			fill_angle_str(angle, 40, h);
 			fprintf(fp, "Velocity:%'.1f kt (%'.0f km/h):%s (%s)\n",
 			       s, KT2KMPH(s),
 			       angle, get_comp_point(h));
 		}
-		if (a->squawks.last && msg->time - a->squawks.last->time < squawk_ttl) {
-			pr_ID(fp, a->squawks.last->ID);
+		if (sqw->h.n && msg->time - sqw->h.last < squawk_ttl) {
+			pr_ID(fp, sqw->ID[history_last(&sqw->h)]);
 		}
 	}
 	
 
-#define PRINTDF(X, NN) case X: pr_DF ## NN (fp, msg->msg, v); break; 
+#define PRINTDF(X, NN) case X: pr_DF ## NN (fp, &p->DF ## NN, v); break; 
 
 	switch (msg->DF) {
 	PRINTDF( 0, 00)
@@ -209,37 +280,21 @@ pr_msg(FILE *fp, const struct ms_msg_t *msg, int v) {
 
 void
 destroy_msg(struct ms_msg_t *msg) {
-	if (msg->raw)
-		free(msg->raw);
-
-	if (msg->aircraft) {
-/*
+	/*
+	 * Messages are destroyed oldest first,
+	 * so it'll be at the head of the list.
+	 */
+	if (msg->aircraft && msg->aircraft->messages == msg) {
+		msg->aircraft->messages = msg->ac_next;
 		if (msg->aircraft->last_msg == msg)
 			msg->aircraft->last_msg = NULL;
-*/
-		if (msg->aircraft->messages == msg)
-			msg->aircraft->messages = NULL;
+		--msg->aircraft->n_msg_aux;
 	}
 
-	if (!msg->msg) {
+	if (msg->arena) {
+		release_arena(msg->arena);
+	} else {
+		free(msg->payload);
 		free(msg);
-		return;
 	}
-
-#define FREEAUX(NN) case NN: { 			\
-	struct ms_DF ## NN ## _t *p = msg->msg;	\
-	if (p->aux) free(p->aux); break; }
-
-	switch (msg->DF) {
-	FREEAUX(16)
-	FREEAUX(17)
-	FREEAUX(18)
-	FREEAUX(19)
-	FREEAUX(20)
-	FREEAUX(21)
-	FREEAUX(24)
-	}
-
-	free(msg->msg);
-	free(msg);
 }
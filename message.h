@@ -45,6 +45,7 @@
 #include "tisb_f.h"
 
 struct ms_aircraft_t;
+struct ms_arena_t;
 
 struct ms_CRC_t {
 	uint32_t crc;
@@ -52,24 +53,51 @@ struct ms_CRC_t {
 	uint32_t syn;
 };
 
+/*
+ * The DF specific part of a message, decoded in place.
+ * Which member is valid is told by the message's DF.
+ */
+union ms_payload_t {
+	struct ms_DF00_t DF00;
+	struct ms_DF04_t DF04;
+	struct ms_DF05_t DF05;
+	struct ms_DF11_t DF11;
+	struct ms_DF16_t DF16;
+	struct ms_DF17_t DF17;
+	struct ms_DF18_t DF18;
+	struct ms_DF19_t DF19;
+	struct ms_DF20_t DF20;
+	struct ms_DF21_t DF21;
+	struct ms_DF24_t DF24;
+};
+
+/*
+ * The payload is kept out of line, as it's only decoded
+ * for some messages and it's larger than all the rest,
+ * so that a message takes two cache lines in an arena.
+ */
 struct ms_msg_t {
-	uint8_t DF;
-	uint8_t BDS;
-	struct ms_CRC_t cksum;
 	time_t time;
+	struct ms_CRC_t cksum;
 	uint32_t addr;
-	size_t len;
-	uint8_t *raw;
-	void *msg;
+	uint8_t raw[14];
+	uint8_t len;
+	uint8_t DF;
+	uint8_t BDS;
+	union ms_payload_t *payload; /* NULL until decoded, see decode_msg */
 	struct ms_msg_t *next;
 	struct ms_msg_t *ac_next;
 	struct ms_aircraft_t *aircraft;
 	void *ext;
+	struct ms_arena_t *arena; /* if not NULL, the message is in it */
 };
 
 
-void   pr_msg(FILE *fp, const struct ms_msg_t*, int v);
+void   pr_msg(FILE *fp, struct ms_msg_t*, int v);
 struct ms_msg_t *mk_msg(uint8_t*, time_t, uint32_t);
+struct ms_msg_t *mk_msg_syn(uint8_t*, time_t, uint32_t, uint32_t);
+struct ms_msg_t *mk_msg_arena(struct ms_arena_t*, uint8_t*, time_t, uint32_t, uint32_t);
+union ms_payload_t *decode_msg(struct ms_msg_t*);
 void   destroy_msg(struct ms_msg_t*);
 
 #endif
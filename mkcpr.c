@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MK_CPR_TBL
+#include "cpr.c"
+
+/*
+ * Writes cpr_tbl.h, the number of NL_lat[] entries below
+ * each whole degree, to stdout. See chkcpr for the checks
+ * of NL and the decoders against [3].
+ */
+int
+main(void) {
+	int d, k;
+
+	for (d = 0, k = 0; d < 87; ++d) {
+		while (k < 58 && NL_lat[k] < d)
+			++k;
+		NL_deg[d] = k;
+		if (k + 2 < 58 && NL_lat[k + 2] < d + 1) {
+			fprintf(stderr, "mkcpr: ERROR: NL changes thrice in %d\n", d);
+			return 1;
+		}
+	}
+
+	printf("/* Generated by mkcpr from NL_lat[] in cpr.c */\n");
+	printf("static const uint8_t NL_deg[87] = {");
+	for (d = 0; d < 87; ++d)
+		printf("%s%d,", d % 15 ? " " : "\n\t", NL_deg[d]);
+	printf("\n};\n");
+	return 0;
+}
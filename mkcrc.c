@@ -0,0 +1,362 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define MK_CRC_TBL
+#ifndef CRC_CLMUL
+#define CRC_CLMUL
+#endif
+#include "crc.c"
+
+#define N_RANDOM (1 << 24)
+#define N_BATCH 100003
+
+/*
+ * Remainder of the n bit polynomial v times x^24,
+ * a bit at a time, as in [1] 3.1.2.3.3.
+ */
+static uint32_t
+crc_bits(uint64_t v, int n) {
+	uint32_t crc = 0;
+
+	while (n--) {
+		uint32_t bit = ((v >> n) & 1) ^ (crc >> 23);
+
+		crc = (crc << 1) & 0x00FFFFFF;
+		if (bit)
+			crc ^= CRC_POLY;
+	}
+	return crc;
+}
+
+/*
+ * The low 64 bits of x^88 divided by the polynomial, by long
+ * division, a bit of the dividend at a time, from the top.
+ * rem then holds the 25 bits from x^i up, and the quotient
+ * gets x^i whenever the polynomial is taken off it.
+ */
+static uint64_t
+barrett_mu(void) {
+	uint32_t rem = 0;
+	uint64_t mu = 0;
+	int i;
+
+	for (i = 88; i >= 0; --i) {
+		rem = rem << 1 | (i == 88);
+		if (rem & 0x01000000) {
+			rem ^= 0x01000000 | CRC_POLY;
+			if (i < 64)
+				mu |= (uint64_t)1 << i;
+		}
+	}
+	return mu;
+}
+
+static int
+check(const char *name, uint32_t (*f)(const uint8_t *), size_t len,
+      const uint8_t *msg) {
+	uint32_t want = crc_bytes(msg, len - 3);
+	uint32_t got = f(msg);
+	size_t i;
+
+	if (got == want)
+		return 0;
+
+	fprintf(stderr, "mkcrc: ERROR: %s of ", name);
+	for (i = 0; i < len; ++i)
+		fprintf(stderr, "%02X", msg[i]);
+	fprintf(stderr, " is %06X, not %06X\n", got, want);
+	return -1;
+}
+
+/*
+ * Each implementation, against crc_bytes, for all messages with
+ * one or two bits set, and N_RANDOM others.
+ */
+static int
+check_impl(const char *name, uint32_t (*f)(const uint8_t *), size_t len) {
+	uint32_t seed = 1;
+	uint8_t msg[14];
+	size_t i, j, k;
+
+	for (i = 0; i < len * 8; ++i) {
+		for (j = i; j < len * 8; ++j) {
+			memset(msg, 0, sizeof(msg));
+			msg[i / 8] |= 0x80 >> (i % 8);
+			msg[j / 8] |= 0x80 >> (j % 8);
+			if (check(name, f, len, msg) < 0)
+				return -1;
+		}
+	}
+
+	for (i = 0; i < N_RANDOM; ++i) {
+		for (k = 0; k < len; ++k) {
+			seed = seed * 1103515245 + 12345;
+			msg[k] = seed >> 16;
+		}
+		if (check(name, f, len, msg) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/*
+ * Syndrome of a message of len bytes, as crc_syndrome,
+ * but a byte at a time.
+ */
+static uint32_t
+syndrome(const uint8_t *msg, size_t len) {
+	return crc_bytes(msg, len - 3)
+	     ^ (msg[len - 3] << 16 | msg[len - 2] << 8 | msg[len - 1]);
+}
+
+/*
+ * crc_syndromes, of a mix of lengths, in batches of
+ * sizes that aren't multiples of CRC_BATCH or four.
+ */
+static int
+check_batch(void) {
+	static uint8_t raw[N_BATCH][14];
+	static const uint8_t *msgs[N_BATCH];
+	static size_t lens[N_BATCH];
+	static uint32_t syns[N_BATCH];
+	uint32_t seed = 1;
+	uint32_t expect;
+	size_t i, k;
+
+	for (i = 0; i < N_BATCH; ++i) {
+		seed = seed * 1103515245 + 12345;
+		lens[i] = (seed >> 16) % 5 ? ((seed >> 20) & 1 ? 14 : 7) : 5;
+		for (k = 0; k < 14; ++k) {
+			seed = seed * 1103515245 + 12345;
+			raw[i][k] = seed >> 16;
+		}
+		msgs[i] = raw[i];
+	}
+
+	crc_syndromes(msgs, lens, syns, N_BATCH);
+	for (i = 0; i < N_BATCH; ++i) {
+		expect = lens[i] == 5 ? 0x0F000000 : syndrome(raw[i], lens[i]);
+		if (syns[i] != expect) {
+			fprintf(stderr, "mkcrc: ERROR: crc_syndromes of message %lu "
+			        "is %06X, not %06X\n", (unsigned long)i,
+			        syns[i], expect);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static uint32_t
+syn_bits(size_t len, int i, int j) {
+	uint8_t msg[14];
+
+	memset(msg, 0, sizeof(msg));
+	msg[i / 8] ^= 0x80 >> (i % 8);
+	if (j >= 0)
+		msg[j / 8] ^= 0x80 >> (j % 8);
+	return syndrome(msg, len);
+}
+
+/*
+ * Adds the pattern of bits i and j, or only i if j is -1, to
+ * t, whose slots are writable here. Patterns are added with
+ * the fewest bits first, so a key already there has as few.
+ */
+static void
+add_fix(const struct crc_fix_tbl_t *t, int i, int j) {
+	uint16_t *slots = (uint16_t *)t->slots;
+	uint32_t key = syn_bits(t == &fix_long ? 14 : 7, i, j) & t->mask;
+	size_t k;
+	unsigned e = FIX_BIT(i) | (j >= 0 ? FIX_BIT2(j) : 0);
+
+	if (!key)
+		return;
+	k = fix_find(t, key);
+	if (slots[k]) {
+		if (!(slots[k] & 0x3F80) == (j < 0))
+			slots[k] |= FIX_REJECT;
+		return;
+	}
+	if (i < FIX_DF_BITS)
+		e |= FIX_REJECT;
+	slots[k] = e;
+}
+
+static void
+mk_fix(const struct crc_fix_tbl_t *t, size_t len) {
+	int i, j;
+
+	for (i = 0; i < (int)len * 8; ++i)
+		add_fix(t, i, -1);
+	for (i = 0; i < (int)len * 8; ++i)
+		for (j = i + 1; j < (int)len * 8; ++j)
+			add_fix(t, i, j);
+}
+
+/*
+ * Each pattern of one or two bits, with random bits outside
+ * mask, should be found by crc_error_bits, unless some other
+ * pattern of as few bits has the same syndrome, or it touches
+ * the DF field, or it's two bits under CRC_IID_MASK, when it
+ * should be rejected. Patterns with the syndrome of one of
+ * fewer bits are fixed as that one, and those that are all
+ * outside mask can't be told at all.
+ */
+static int
+check_fix(size_t len, uint32_t mask) {
+	int n_bits = len * 8;
+	uint32_t seed = 1;
+	int i, j, k, l;
+
+	for (i = 0; i < n_bits; ++i) {
+		for (j = -1; j < n_bits; ++j) {
+			uint32_t key = syn_bits(len, i, j) & mask;
+			bool fewer = false;
+			bool tie = false;
+			int bits[2];
+			int want = j < 0 ? 1 : 2;
+			int got;
+
+			if (j >= 0 && j <= i)
+				continue;
+			if (!key)
+				continue;
+
+			for (k = 0; k < n_bits; ++k) {
+				for (l = -1; l < (j < 0 ? 0 : n_bits); ++l) {
+					if ((l >= 0 && l <= k) || (k == i && l == j))
+						continue;
+					if ((syn_bits(len, k, l) & mask) != key)
+						continue;
+					if (l < 0 && j >= 0)
+						fewer = true;
+					else
+						tie = true;
+				}
+			}
+			if (fewer)
+				continue;
+
+			seed = seed * 1103515245 + 12345;
+			got = crc_error_bits(len, key | ((seed >> 16) & ~mask & 0xFFFFFF),
+			                     mask, 2, bits);
+			if (mask == CRC_IID_MASK && j >= 0)
+				want = -1;
+			if (!tie && i >= FIX_DF_BITS && want > 0 ? got != want || bits[0] != i || (j >= 0 && bits[1] != j)
+			           : got != -1) {
+				fprintf(stderr, "mkcrc: ERROR: bits %d,%d of %lu byte "
+				        "messages, masked %06X, fixed as %d\n", i, j,
+				        (unsigned long)len, mask, got);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void
+pr_u16(const char *decl, const uint16_t *t, size_t len) {
+	size_t i;
+
+	printf("%s[%lu] = {", decl, (unsigned long)len);
+	for (i = 0; i < len; ++i)
+		printf("%s0x%04x,", i % 10 ? " " : "\n\t", t[i]);
+	printf("\n};\n");
+}
+
+static void
+pr_u32(const char *decl, const uint32_t *t, size_t len) {
+	size_t i;
+
+	printf("%s[%lu] = {", decl, (unsigned long)len);
+	for (i = 0; i < len; ++i)
+		printf("%s0x%06x,", i % 8 ? " " : "\n\t", t[i]);
+	printf("\n};\n");
+}
+
+/*
+ * Writes crc_tbl.h, the tables crc.c computes parity with, to
+ * stdout, after checking crc_table against the polynomial, and
+ * each implementation against crc_table, byte at a time.
+ */
+int
+main(void) {
+	size_t b, k;
+
+	for (b = 0; b < 256; ++b) {
+		if (crc_table[b] != crc_bits(b, 8)) {
+			fprintf(stderr, "mkcrc: ERROR: crc_table[%lu] is %06X, not %06X\n",
+			        (unsigned long)b, crc_table[b], crc_bits(b, 8));
+			return 1;
+		}
+		crc_slices[0][b] = crc_table[b];
+	}
+	for (k = 1; k < 8; ++k) {
+		for (b = 0; b < 256; ++b) {
+			uint32_t crc = crc_slices[k - 1][b];
+
+			crc_slices[k][b] = ((crc << 8) & 0x00FFFFFF) ^ crc_table[crc >> 16];
+		}
+	}
+	crc_mu = barrett_mu();
+
+	for (b = 0; b < 56; ++b)
+		crc_syn_short[b] = syn_bits(7, b, -1);
+	for (b = 0; b < 112; ++b)
+		crc_syn_long[b] = syn_bits(14, b, -1);
+	mk_fix(&fix_short, 7);
+	mk_fix(&fix_iid, 7);
+	mk_fix(&fix_long, 14);
+
+	if (check_impl("crc56_sliced", crc56_sliced, 7) < 0
+	 || check_impl("crc112_sliced", crc112_sliced, 14) < 0
+	 || check_batch() < 0)
+		return 1;
+#ifdef CRC_CLMUL
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("pclmul")
+	 && (check_impl("crc56_clmul", crc56_clmul, 7) < 0
+	  || check_impl("crc112_clmul", crc112_clmul, 14) < 0))
+		return 1;
+#endif
+	if (check_fix(7, 0xFFFFFF) < 0
+	 || check_fix(7, CRC_IID_MASK) < 0
+	 || check_fix(14, 0xFFFFFF) < 0)
+		return 1;
+
+	printf("/* Generated by mkcrc from crc_table[] in crc.c */\n");
+	printf("static const uint32_t crc_slices[8][256] = {");
+	for (k = 0; k < 8; ++k) {
+		printf("%s{", k ? ", " : "\n\t");
+		for (b = 0; b < 256; ++b)
+			printf("%s0x%06x,", b % 8 ? " " : "\n\t\t", crc_slices[k][b]);
+		printf("\n\t}");
+	}
+	printf("\n};\n");
+	printf("static const uint64_t crc_mu = UINT64_C(0x%08lx%08lx);\n",
+	       (unsigned long)(crc_mu >> 32), (unsigned long)(crc_mu & 0xFFFFFFFF));
+	pr_u32("static const uint32_t crc_syn_short", crc_syn_short, 56);
+	pr_u32("static const uint32_t crc_syn_long", crc_syn_long, 112);
+	pr_u16("static const uint16_t crc_fix_short", crc_fix_short, 1 << FIX_SHORT_BITS);
+	pr_u16("static const uint16_t crc_fix_iid", crc_fix_iid, 1 << FIX_SHORT_BITS);
+	pr_u16("static const uint16_t crc_fix_long", crc_fix_long, 1 << FIX_LONG_BITS);
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define MK_NATION_TBL
+#include "nation.c"
+
+#define TOP_LEN  (1 << (24 - NATION_TOP_SHIFT))
+#define FINE_LEN (1 << NATION_FINE_BITS)
+
+static uint16_t top[TOP_LEN];
+static uint8_t fine[TOP_LEN * FINE_LEN];
+
+static void
+pr_table(const char *decl, const unsigned *t, size_t len) {
+	size_t i;
+
+	printf("%s[%lu] = {", decl, (unsigned long)len);
+	for (i = 0; i < len; ++i)
+		printf("%s%3u,", i % 12 ? " " : "\n\t", t[i]);
+	printf("\n};\n");
+}
+
+/*
+ * Writes nation_tbl.h, the tables nation.c looks up addresses
+ * in, to stdout, after checking that they give the same state
+ * as a scan of states[] for each and every address.
+ */
+int
+main(void) {
+	static unsigned out[TOP_LEN * FINE_LEN];
+	size_t n_fine = 0;
+	uint32_t addr;
+	size_t i, j;
+
+	if (sizeof(states) / sizeof(states[0]) > 0xFF) {
+		fprintf(stderr, "mknation: ERROR: Too many states\n");
+		return 1;
+	}
+
+	for (i = 0; i < TOP_LEN; ++i) {
+		unsigned idx[FINE_LEN];
+		bool same = true;
+
+		for (j = 0; j < FINE_LEN; ++j) {
+			idx[j] = scan_states((i << NATION_TOP_SHIFT) | (j << NATION_FINE_SHIFT));
+			same = same && idx[j] == idx[0];
+		}
+		if (same) {
+			top[i] = idx[0];
+			continue;
+		}
+		for (j = 0; j < FINE_LEN; ++j)
+			fine[n_fine * FINE_LEN + j] = idx[j];
+		top[i] = NATION_FINE | n_fine++;
+	}
+
+	for (addr = 0; addr < 1 << 24; ++addr) {
+		unsigned want = scan_states(addr);
+		unsigned got = nation_index(top, fine, addr);
+
+		if (got != want) {
+			fprintf(stderr, "mknation: ERROR: %06X is %s, not %s\n",
+			        addr, states[want].iso3, states[got].iso3);
+			return 1;
+		}
+	}
+
+	printf("/* Generated by mknation from states[] in nation.c */\n");
+	for (i = 0; i < TOP_LEN; ++i)
+		out[i] = top[i];
+	pr_table("static const uint16_t nation_top", out, TOP_LEN);
+	for (i = 0; i < n_fine * FINE_LEN; ++i)
+		out[i] = fine[i];
+	pr_table("static const uint8_t nation_fine", out,
+	         n_fine ? n_fine * FINE_LEN : 1);
+
+	return 0;
+}
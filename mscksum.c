@@ -14,53 +14,251 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
-#include <ctype.h>
 #include <string.h>
+#include <time.h>
+
+#include <arg.h>
 
 #include "crc.h"
+#include "hex.h"
+
+/*
+ * Frames read ahead from stdin, and checked together.
+ */
+struct frames_t {
+	char line[CRC_BATCH][28]; /* hex, as given */
+	uint8_t raw[CRC_BATCH][14];
+	const uint8_t *msgs[CRC_BATCH];
+	size_t lens[CRC_BATCH];
+	uint32_t syns[CRC_BATCH];
+	size_t n;
+};
 
-static uint8_t
-strtohex(uint8_t x) {
-	if      (x <= '9') return x - '0';
-	else if (x <= 'F') return x - 'A' + 10;
-	else if (x <= 'f') return x - 'a' + 10;
-	return 0xFF;
+static void
+usage() {
+	printf("usage: %s [-b frames] [message ...]\n", argv0);
+	exit(1);
 }
 
-int
-main(int argc, char *argv[]) {
-	int i;
+/*
+ * Hex of a message, optionally as *...;, into msg.
+ * Returns its length, or -1 if it isn't one.
+ */
+static int
+parse_hex(char *s, uint8_t *msg) {
+	size_t len;
 
-	for (i = 1; i < argc; ++i) {
-		uint8_t msg[14];
-		size_t j, len = strlen(argv[i]) / 2;
-		uint8_t *p = (uint8_t *)argv[i];
-		uint32_t crc;
-		uint32_t sum; 
+	s[strcspn(s, "\r\n")] = '\0';
+	if (*s == '*')
+		++s;
+	len = strlen(s);
+	if (len && s[len - 1] == ';')
+		--len;
 
-		if (len != 7 && len != 14)
-			return 1;
-		if (strlen(argv[i]) % 2)
-			return 1;
+	if (len != 14 && len != 28)
+		return -1;
+	if (hex_to_bytes(s, msg, len / 2) < 0)
+		return -1;
+	return len / 2;
+}
+
+static void
+pr_cksum(const char *s, const uint8_t *msg, size_t len, uint32_t syn) {
+	uint32_t sum = (msg[len - 3] << 16)
+	             | (msg[len - 2] <<  8)
+	             | (msg[len - 1] <<  0);
 
-		for (j = 0; j < len; ++j) {
-			if (!isxdigit(*p) || !isxdigit(*(p+1)))
-				return 1;
-			uint8_t a = strtohex(*p++);
-			uint8_t b = strtohex(*p++);
-			msg[j] = (a << 4) | b;
+	printf("%.*s:%06X:%06X:%06X\n", (int)len * 2, s, syn ^ sum, sum, syn);
+}
+
+static void
+flush_frames(struct frames_t *f) {
+	size_t i;
+
+	crc_syndromes(f->msgs, f->lens, f->syns, f->n);
+	for (i = 0; i < f->n; ++i)
+		pr_cksum(f->line[i], f->raw[i], f->lens[i], f->syns[i]);
+	f->n = 0;
+}
+
+/*
+ * Messages on stdin, one per line, a block at a time.
+ */
+static int
+stream(void) {
+	struct frames_t *f;
+	char line[256];
+	int err = 0;
+	int len;
+
+	if (!(f = calloc(1, sizeof(struct frames_t)))) {
+		fprintf(stderr, "%s: FATAL: calloc: out of memory\n", argv0);
+		exit(1);
+	}
+
+	while (fgets(line, sizeof(line), stdin)) {
+		if ((len = parse_hex(line, f->raw[f->n])) < 0) {
+			fprintf(stderr, "%s: ERROR: %s: not a message\n", argv0, line);
+			err = 1;
+			continue;
 		}
+		memcpy(f->line[f->n], line + (*line == '*'), len * 2);
+		f->msgs[f->n] = f->raw[f->n];
+		f->lens[f->n] = len;
+		if (++f->n == CRC_BATCH) {
+			flush_frames(f);
+			fflush(stdout);
+		}
+	}
+	flush_frames(f);
 
-		crc = checksum(msg, len);
-		sum = (msg[len - 3] << 16)
-		    | (msg[len - 2] <<  8)
-		    | (msg[len - 1] <<  0);
-		printf("%s:%06X:%06X:%06X\n",argv[i], crc, sum, crc^sum);
+	free(f);
+	return err;
+}
+
+static double
+elapsed(const struct timespec *t0) {
+	struct timespec t1;
 
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) / 1e9;
+}
 
+/*
+ * Syndromes of n frames, repeating those given, as mk_msg
+ * found them, one by one with checksum, and as the parser
+ * now does, with crc_syndromes.
+ */
+static int
+bench(uint8_t (*given)[14], const size_t *given_lens, size_t ngiven, size_t n) {
+	uint8_t (*raw)[14];
+	const uint8_t **msgs;
+	size_t *lens;
+	uint32_t *syns;
+	uint32_t sum_one = 0, sum_batch = 0;
+	struct timespec t0;
+	double t_one, t_batch;
+	size_t i;
+	int err = 0;
+
+	raw = malloc(n * sizeof(*raw));
+	msgs = malloc(n * sizeof(*msgs));
+	lens = malloc(n * sizeof(*lens));
+	syns = malloc(n * sizeof(*syns));
+	if (!raw || !msgs || !lens || !syns) {
+		fprintf(stderr, "%s: FATAL: malloc: out of memory\n", argv0);
+		exit(1);
 	}
-	
+
+	for (i = 0; i < n; ++i) {
+		memcpy(raw[i], given[i % ngiven], 14);
+		lens[i] = given_lens[i % ngiven];
+		msgs[i] = raw[i];
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < n; ++i) {
+		size_t len = lens[i];
+
+		sum_one += checksum(raw[i], len)
+		         ^ (raw[i][len - 3] << 16 | raw[i][len - 2] << 8 | raw[i][len - 1]);
+	}
+	t_one = elapsed(&t0);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	crc_syndromes(msgs, lens, syns, n);
+	for (i = 0; i < n; ++i)
+		sum_batch += syns[i];
+	t_batch = elapsed(&t0);
+
+	if (sum_one != sum_batch) {
+		fprintf(stderr, "%s: ERROR: syndromes differ\n", argv0);
+		err = 1;
+	}
+
+	printf("checksum:      %lu frames, %.0f frames/s\n",
+	       (unsigned long)n, n / t_one);
+	printf("crc_syndromes: %lu frames, %.0f frames/s\n",
+	       (unsigned long)n, n / t_batch);
+
+	free(raw);
+	free(msgs);
+	free(lens);
+	free(syns);
+	return err;
+}
+
+/*
+ * Frames to benchmark, from the arguments or stdin.
+ */
+static int
+bench_input(char **argv, size_t n) {
+	uint8_t (*raw)[14] = NULL;
+	size_t *lens = NULL;
+	size_t nraw = 0, size = 0;
+	bool from_stdin = !*argv;
+	char line[256];
+	char *s;
+	int len;
+	int err;
+
+	while ((s = from_stdin ? fgets(line, sizeof(line), stdin) : *argv++)) {
+		if (nraw == size) {
+			size = size ? size * 2 : 1024;
+			raw = realloc(raw, size * sizeof(*raw));
+			lens = realloc(lens, size * sizeof(*lens));
+			if (!raw || !lens) {
+				fprintf(stderr, "%s: FATAL: realloc: out of memory\n", argv0);
+				exit(1);
+			}
+		}
+		if ((len = parse_hex(s, raw[nraw])) < 0)
+			continue;
+		lens[nraw++] = len;
+	}
+
+	if (!nraw) {
+		fprintf(stderr, "%s: ERROR: no messages to benchmark\n", argv0);
+		return 1;
+	}
+
+	err = bench(raw, lens, nraw, n);
+	free(raw);
+	free(lens);
+	return err;
+}
+
+int
+main(int argc, char *argv[]) {
+	size_t nbench = 0;
+	uint8_t msg[14];
+	int len;
+
+	ARGBEGIN {
+	case 'b':
+		nbench = strtoul(EARGF(usage()), NULL, 10);
+		if (!nbench)
+			usage();
+		break;
+	default:
+		usage();
+	} ARGEND;
+
+	if (nbench)
+		return bench_input(argv, nbench);
+
+	if (!argc)
+		return stream();
+
+	for (; *argv; ++argv) {
+		if ((len = parse_hex(*argv, msg)) < 0)
+			return 1;
+		pr_cksum(**argv == '*' ? *argv + 1 : *argv, msg, len, crc_syndrome(msg, len));
+	}
+
 	return 0;
 }
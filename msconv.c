@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arg.h>
+
+#include "parse.h"
+#include "reader.h"
+#include "archive.h"
+
+enum {
+	OUT_ARCHIVE,
+	OUT_TEXT,
+	OUT_DUMP
+};
+
+static struct {
+	enum ms_format_t format;
+	int output;
+} options;
+
+static void
+pr_hex(FILE *fp, const struct ms_frame_t *frame) {
+	size_t i;
+
+	for (i = 0; i < frame->len; ++i)
+		fprintf(fp, "%02X", frame->raw[i]);
+}
+
+static int
+conv(const char *filename, FILE *fp) {
+	struct ms_reader_t *r;
+	struct ms_frame_t frame;
+	uint8_t rec[ARCHIVE_RECLEN];
+
+	if (!(r = mk_reader(filename, 0))) {
+		fprintf(stderr, "%s: ERROR: Failed to open %s: %s\n",
+		        argv0, filename ? filename : "stdin", strerror(errno));
+		return -1;
+	}
+	r->format = options.format;
+
+	if (options.output == OUT_ARCHIVE) {
+		mk_archive_header(rec);
+		fwrite(rec, ARCHIVE_HDRLEN, 1, fp);
+	}
+
+	while (read_frame(r, &frame) > 0) {
+		switch (options.output) {
+		case OUT_ARCHIVE:
+			frame_to_record(&frame, rec);
+			fwrite(rec, ARCHIVE_RECLEN, 1, fp);
+			break;
+		case OUT_TEXT:
+			fprintf(fp, "DF%02d:", frame.raw[0] >> 3);
+			if (frame.time)
+				fprintf(fp, "%ld:", (long)frame.time);
+			pr_hex(fp, &frame);
+			if (!(frame.addr & 0xFF000000))
+				fprintf(fp, ":%06X", frame.addr);
+			fputc('\n', fp);
+			break;
+		case OUT_DUMP:
+			fputc('*', fp);
+			pr_hex(fp, &frame);
+			fputs(";\n", fp);
+			break;
+		}
+	}
+
+	if (destroy_reader(r) < 0) {
+		fprintf(stderr, "%s: ERROR: Failed to read %s: %s\n",
+		        argv0, filename ? filename : "stdin", strerror(errno));
+		return -1;
+	}
+
+	if (fflush(fp) == EOF) {
+		fprintf(stderr, "%s: ERROR: Failed to write output: %s\n",
+		        argv0, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+usage() {
+	printf("usage: %s [options] [file]\n", argv0);
+	printf("options:\n"
+	       " -b:\tInput is in Beast binary format\n"
+	       " -o f:\tOutput format, f ∈ { archive, text, dump }\n"
+	);
+
+	exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+	char *s;
+
+	memset(&options, 0, sizeof(options));
+	options.output = OUT_ARCHIVE;
+
+	ARGBEGIN {
+	case 'b':
+		options.format = FORMAT_BEAST;
+		break;
+	case 'o':
+		s = EARGF(usage());
+		if (!strcmp(s, "archive"))
+			options.output = OUT_ARCHIVE;
+		else if (!strcmp(s, "text"))
+			options.output = OUT_TEXT;
+		else if (!strcmp(s, "dump"))
+			options.output = OUT_DUMP;
+		else
+			usage();
+		break;
+	default:
+		usage();
+	} ARGEND;
+
+	if (argc > 1)
+		usage();
+
+	if (options.output == OUT_ARCHIVE && isatty(STDOUT_FILENO)) {
+		fprintf(stderr, "%s: ERROR: Won't write archive to a terminal\n", argv0);
+		return 1;
+	}
+
+	return conv(argc ? argv[0] : NULL, stdout) < 0 ? 1 : 0;
+}
@@ -36,8 +36,10 @@
 #include "util.h"
 #include "stats.h"
 #include "parse.h"
+#include "merge.h"
+#include "index.h"
+#include "dedup.h"
 #include "dump.h"
-#include "inot.h"
 
 #define CONF_MSDEC
 #include "config.h"
@@ -52,6 +54,17 @@ static struct {
 	bool dump_messages;
 	bool dump_histogram;
 	bool plot_histogram;
+	enum ms_format_t format;
+	int threads;
+	size_t batch;
+	time_t ttl;
+	size_t budget;
+	time_t from;
+	time_t to;
+	uint8_t *addrs;
+	time_t dedup_window;
+	const char *sock_addr;
+	bool sock_listen;
 	int histogram_incr;
 	int print_mode;
 	const char *aircraft_dir;
@@ -59,22 +72,163 @@ static struct {
 	const char *stats_filename;
 } options;
 
+struct batch_t {
+	struct ms_histogram_t *histogram;
+	struct ms_stats_t *stats;
+	const char *acdumpdir;
+	uint8_t *logged; /* see dump_flightlog */
+	int err;
+};
+
+static int
+handle_msgs(struct ms_msg_t *msgs, void *arg) {
+	struct batch_t *b = arg;
+	struct ms_msg_t *msg;
+
+	if (b->histogram) {
+		update_histogram(b->histogram, msgs);
+	}
+	
+	if (b->stats) {
+		update_stats(b->stats, msgs);
+	}
+
+	if (options.dump_messages) {
+		b->err += dump_messages(msgs, b->acdumpdir);
+	}
+
+	if (options.print_msgs) {
+		for (msg = msgs; msg; msg = msg->next) {
+			pr_msg(stdout, msg, options.print_mode);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Aircrafts retired along the way are dumped and counted
+ * as they go, the rest when all is read.
+ */
+static void
+retire_aircraft(struct ms_aircraft_t *a, void *arg) {
+	struct batch_t *b = arg;
+
+	if (b->stats && retire_stats(b->stats, a) < 0) {
+		fprintf(stderr, "%s: ERROR: Failed to count %06X: %s\n",
+		        argv0, a->addr, strerror(errno));
+		b->err -= 1;
+	}
+	if (options.dump_flightlogs)
+		b->err += dump_flightlog(a, b->acdumpdir, b->logged);
+}
+
+/*
+ * With a time range, only the part of the file that may
+ * be in range is read, as told by its index.
+ */
+static struct ms_reader_t *
+open_input(const char *filename) {
+	struct ms_index_t *idx = NULL;
+	struct ms_reader_t *r;
+	off_t offset = 0;
+	off_t end = 0;
+
+	if (filename && (options.from || options.to)) {
+		if ((idx = update_index(filename))) {
+			offset = index_start(idx, options.from);
+			if (options.to)
+				end = index_end(idx, options.to);
+		} else {
+			fprintf(stderr, "%s: WARNING: Can't index %s: %s\n",
+			        argv0, filename, strerror(errno));
+		}
+	}
+
+	if (options.follow && filename)
+		r = mk_tailer(filename, offset);
+	else
+		r = mk_reader(filename, offset);
+
+	if (!r) {
+		fprintf(stderr, "%s: ERROR: Failed to open %s: %s\n",
+		        argv0, filename ? filename : "stdin", strerror(errno));
+		if (idx)
+			destroy_index(idx);
+		return NULL;
+	}
+	r->format = offset ? idx->format : options.format;
+	r->end = end;
+
+	if (idx)
+		destroy_index(idx);
+	return r;
+}
+
+/*
+ * Several files are merged into one stream, in the
+ * order of time, as if they had been a single file.
+ */
+static struct ms_reader_t *
+open_inputs(char **filenames, int n) {
+	struct ms_reader_t **readers;
+	struct ms_reader_t *r;
+	int i;
+
+	if (n < 2)
+		return open_input(n ? filenames[0] : NULL);
+
+	readers = calloc(n, sizeof(struct ms_reader_t *));
+	for (i = 0; i < n; ++i) {
+		if (!(readers[i] = open_input(filenames[i]))) {
+			while (i--)
+				destroy_reader(readers[i]);
+			free(readers);
+			return NULL;
+		}
+	}
+	r = mk_merger(readers, n);
+	free(readers);
+
+	return r;
+}
+
 static int
-cat(const char *filename) {
-	struct ms_aircraft_t *aircrafts = NULL;
+cat(char **filenames, int n) {
+	struct ms_ac_table_t *aircrafts;
 	struct ms_histogram_t *histogram = NULL;
 	struct ms_stats_t *stats = NULL;
-	off_t offset = 0;
+	struct batch_t batch;
+	struct ms_reader_t *r;
 	int err = 0;
-	int ifd = -1;
-	int iwfd = -1;
 	char *acdumpdir = NULL;
 
-	if (options.follow && init_inotify(filename, &ifd, &iwfd) < 0) {
-		fprintf(stderr, "%s: ERROR: Failed to setup inotify on %s: %s\n",
-		        argv0, filename, strerror(errno));
+	if (options.sock_addr) {
+		if (!(r = mk_sock_reader(options.sock_addr, options.sock_listen))) {
+			fprintf(stderr, "%s: ERROR: Failed to %s %s: %s\n", argv0,
+			        options.sock_listen ? "listen on" : "connect to",
+			        options.sock_addr, strerror(errno));
+			return -1;
+		}
+		r->format = options.format;
+	} else if (!(r = open_inputs(filenames, n))) {
 		return -1;
 	}
+	r->threads = options.threads;
+	r->batch = options.batch;
+	r->from = options.from;
+	r->to = options.to;
+	r->addrs = options.addrs;
+	if (options.dedup_window)
+		r->dedup = mk_dedup(options.dedup_window);
+
+	/*
+	 * Without messages to print or aircrafts to dump,
+	 * there's no need to decode more than the names.
+	 */
+	r->untracked = !options.print_msgs
+	            && !options.dump_flightlogs
+	            && !options.dump_messages;
 
 	if (options.dump_histogram) {
 		histogram = mk_histogram(options.histogram_incr, options.hist_filename);
@@ -100,61 +254,69 @@ cat(const char *filename) {
 		stats = mk_stats();
 	}
 
+	aircrafts = mk_ac_table();
 
-	do {
-		struct ms_msg_t *msgs;
-
-		msgs = parse_file(filename, &offset, &aircrafts);
+	batch.histogram = histogram;
+	batch.stats = stats;
+	batch.acdumpdir = acdumpdir;
+	batch.logged = options.dump_flightlogs ? mk_addr_filter() : NULL;
+	batch.err = 0;
 
-		if (!msgs && errno) {
-			err -= 1;
-			fprintf(stderr, "%s: Failed to parse file %s: %s\n",
-				argv0, filename ? filename : "stdin", strerror(errno));
-			break;
-		}
+	aircrafts->ttl = options.ttl;
+	aircrafts->budget = options.budget;
+	aircrafts->retire = retire_aircraft;
+	aircrafts->retire_arg = &batch;
 
-		if (options.dump_histogram) {
-			update_histogram(histogram, msgs);
-		}
-		
-		if (stats) {
-			update_stats(stats, msgs);
-		}
+	for (;;) {
+		int ret;
 
-		if (options.dump_messages) {
-			err += dump_messages(msgs, acdumpdir);
-		}
+		parse_stream(r, aircrafts, handle_msgs, &batch);
 
-		while (msgs) {
-			struct ms_msg_t *tmp = msgs->next;
-			if (options.print_msgs) {
-				pr_msg(stdout, msgs, options.print_mode);
-			}
-			destroy_msg(msgs);
-			msgs = tmp;
-		}
+		if (!r->follow)
+			break;
 
-		if (options.follow && wait_for_inotify(ifd) < 0) {
-			printf("Input file %s seems to have disappeared.\n", filename);
+		/*
+		 * Rotated or truncated, there's
+		 * more to read right away.
+		 */
+		if ((ret = follow_reader(r)) > 0)
+			continue;
+		if (ret < 0 || wait_reader(r) < 0) {
+			fprintf(stderr, "%s: ERROR: Failed to follow %s: %s\n", argv0,
+			        r->sock ? options.sock_addr : filenames[0], strerror(errno));
+			err -= 1;
 			break;
 		}
-	} while (options.follow);
+	}
 
-	if (iwfd >= 0) {
-		close(iwfd);
+	err += batch.err;
+
+	if (r->dedup) {
+		if (stats)
+			stats->n_dups = r->dedup->suppressed;
+		destroy_dedup(r->dedup);
 	}
-	if (ifd >= 0) {
-		close(ifd);
+
+	/*
+	 * Compressed input that's corrupt or truncated is only
+	 * told when it's done with, and may have been merged.
+	 */
+	if (destroy_reader(r) < 0) {
+		fprintf(stderr, "%s: ERROR: Failed to read %s: %s\n", argv0,
+		        options.sock_addr ? options.sock_addr
+		        : n == 1 ? filenames[0] : n ? "one of the inputs" : "stdin",
+		        strerror(errno));
+		err -= 1;
 	}
 
 	if (options.dump_flightlogs) {
 		struct ms_aircraft_t *tmp;
-		for (tmp = aircrafts; tmp; tmp = tmp->next)
-			err += dump_flightlog(tmp, acdumpdir);
+		for (tmp = aircrafts->head; tmp; tmp = tmp->next)
+			err += dump_flightlog(tmp, acdumpdir, batch.logged);
 	}
 
 	if (stats) {
-		finalise_stats(stats, aircrafts);
+		finalise_stats(stats, aircrafts->head);
 
 		if (options.print_stats) {
 			pr_stats(stats);
@@ -178,27 +340,115 @@ cat(const char *filename) {
 	if (acdumpdir) {
 		free(acdumpdir);
 	}
+	free(batch.logged);
 
 
-	while (aircrafts) {
-		struct ms_aircraft_t *tmp;
-		
-		tmp = aircrafts->next;
-		destroy_aircraft(aircrafts);
-		aircrafts = tmp;
-	}
+	destroy_ac_table(aircrafts);
 
 	return err ? -1 : 0;
 }
 
 
 
+/*
+ * FROM..TO, in seconds since the epoch, either of which may be
+ * left out, as in FROM.. or ..TO, for an open ended range.
+ */
+static int
+parse_range(const char *s) {
+	const char *dots;
+	char *end;
+
+	if (!(dots = strstr(s, "..")))
+		return -1;
+
+	if (dots != s) {
+		options.from = strtol(s, &end, 10);
+		if (end != dots)
+			return -1;
+	}
+	if (dots[2]) {
+		options.to = strtol(dots + 2, &end, 10);
+		if (*end)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Adds the hexadecimal addresses in s, separated by commas
+ * or white space, to the address filter. A # starts a comment.
+ */
+static int
+add_addrs(char *s) {
+	char *tok;
+
+	if (!options.addrs)
+		options.addrs = mk_addr_filter();
+
+	if ((tok = strchr(s, '#')))
+		*tok = '\0';
+
+	for (tok = strtok(s, ", \t\n"); tok; tok = strtok(NULL, ", \t\n")) {
+		unsigned long addr;
+		char *end;
+
+		addr = strtoul(tok, &end, 16);
+		if (*end || addr > 0xFFFFFF) {
+			fprintf(stderr, "%s: ERROR: Invalid address: %s\n", argv0, tok);
+			return -1;
+		}
+		add_addr_filter(options.addrs, addr);
+	}
+
+	return 0;
+}
+
+/*
+ * ADDR[,ADDR...], or @file with addresses.
+ */
+static int
+parse_addrs(const char *s) {
+	char line[BUFSIZ];
+	FILE *fp;
+	int err = 0;
+
+	if (*s != '@') {
+		char *tmp = strdup(s);
+
+		err = add_addrs(tmp);
+		free(tmp);
+		return err;
+	}
+
+	if (!(fp = fopen(s + 1, "r"))) {
+		fprintf(stderr, "%s: ERROR: Failed to open %s: %s\n",
+		        argv0, s + 1, strerror(errno));
+		return -1;
+	}
+	while (!err && fgets(line, sizeof(line), fp))
+		err = add_addrs(line);
+	fclose(fp);
+
+	return err;
+}
+
 static void
 usage() {
-	printf("usage: %s [options] <file>\n", argv0);
+	printf("usage: %s [options] [file ...]\n", argv0);
 	printf("usage: %s -m <msg ...>\n", argv0);
 	printf("options:\n"
 	       " -f:\tFollow input file as it grows\n"
+	       " -b:\tInput is in Beast binary format\n"
+	       " -j n:\tParse with n threads, 0 for one per processor\n"
+	       " -B n:\tDecode in batches of n KiB of input, 0 for all at once\n"
+	       " -c addr:\tRead from socket addr, a path or [host:]port\n"
+	       " -l addr:\tListen on socket addr for a client to read from\n"
+	       " -d n:\tDrop messages seen before, less than n seconds ago\n"
+	       " -T n:\tRetire aircrafts not seen for n seconds, 0 for never\n"
+	       " -M n:\tTrim aircrafts' history to n MiB, 0 for no limit\n"
+	       " -t a..b:\tOnly messages from time a until b of time ordered input, either may be left out\n"
 	       " -r:\tRaw output\n"
 	       " -ns:\tNo statistics output on stdout\n"
 	       " -nm:\tNo message output on stdout\n"
@@ -209,6 +459,7 @@ usage() {
 	       " -al:\tDump aircraft logs\n"
 	       " -am:\tDump aircraft messages\n"
 	       " -A dn:\tDirectory for aircraft dumps\n"
+	       " -i a,b:\tOnly messages from aircrafts a, b, ..., or those in @file\n"
 	);
 
 	exit(1);
@@ -226,6 +477,10 @@ main(int argc, char *argv[]) {
 	options.hist_filename = default_histogram_filename;
 	options.stats_filename = default_statistics_filename;
 	options.aircraft_dir = default_aircraft_directory;
+	options.threads = default_threads;
+	options.batch = 1024 * default_batch;
+	options.ttl = default_aircraft_ttl;
+	options.budget = 1024 * 1024 * default_memory_budget;
 
 	ARGBEGIN {
 	case 'n':
@@ -250,6 +505,49 @@ main(int argc, char *argv[]) {
 		options.follow = true;
 		break;
 
+	case 'b':
+		options.format = FORMAT_BEAST;
+		break;
+
+	case 'j':
+		options.threads = atoi(EARGF(usage()));
+		break;
+
+	case 'B':
+		options.batch = 1024 * strtoul(EARGF(usage()), NULL, 10);
+		break;
+
+	case 'c':
+		options.sock_addr = EARGF(usage());
+		options.sock_listen = false;
+		break;
+
+	case 'l':
+		options.sock_addr = EARGF(usage());
+		options.sock_listen = true;
+		break;
+
+	case 'd':
+		options.dedup_window = atoi(EARGF(usage()));
+		if (options.dedup_window <= 0)
+			usage();
+		break;
+
+	case 'T':
+		options.ttl = atoi(EARGF(usage()));
+		if (options.ttl < 0)
+			usage();
+		break;
+
+	case 'M':
+		options.budget = 1024 * 1024 * strtoul(EARGF(usage()), NULL, 10);
+		break;
+
+	case 't':
+		if (parse_range(EARGF(usage())) < 0)
+			usage();
+		break;
+
 	case 'm':
 		options.msg_on_cmdline = true;
 		break;
@@ -271,6 +569,11 @@ main(int argc, char *argv[]) {
 			usage();
 		break;
 
+	case 'i':
+		if (parse_addrs(EARGF(usage())) < 0)
+			usage();
+		break;
+
 	case 'S':
 		options.stats_filename = EARGF(usage());
 		break;
@@ -330,10 +633,20 @@ main(int argc, char *argv[]) {
 		return err ? 1 : 0;
 	}
 
-	if (argc > 1)
+	/*
+	 * Only a single file can be followed.
+	 */
+	if (options.follow && argc > 1)
 		usage();
+	if (options.sock_addr && argc)
+		usage();
+
+	if (options.threads <= 0)
+		options.threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+	err += cat(argv, argc);
 
-	err += cat(argc ? argv[0] : NULL);
+	free(options.addrs);
 
 	return err ? 1 : 0;
 }
@@ -14,7 +14,6 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <sys/inotify.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdbool.h>
@@ -41,7 +40,6 @@
 #include "util.h"
 #include "parse.h"
 #include "sources.h"
-#include "inot.h"
 
 #define CONF_MSGUI
 #include "config.h"
@@ -105,11 +103,13 @@ static struct {
 
 	int message_cache;
 	bool show_home;
+	enum ms_format_t format;
+	const char *input;
 	double home_lat;
 	double home_lon;
 } gui;
 
-struct ms_aircraft_t *aircrafts = NULL;
+struct ms_ac_table_t *aircrafts = NULL;
 
 enum {
 	COL_SEL_CURR = 0,
@@ -162,8 +162,8 @@ update_info(const struct ms_aircraft_t *a) {
 			i += snprintf(text + i, sizeof(text) - 1 - i, "%s / ", a->name);
 		snprintf(text + i, sizeof(text) - 1 - i, "%s", a->nation->name);
 		gtk_label_set_text(gui.info.reg, text);
-		if (a->velocities.last) {
-			int vr = a->velocities.last->vrate;
+		if (a->velocities.h.n) {
+			int vr = a->velocities.vrate[history_last(&a->velocities.h)];
 			int a = vr < 0 ? -vr : vr;
 			
 			snprintf(text, sizeof(text) - 1,
@@ -174,9 +174,9 @@ update_info(const struct ms_aircraft_t *a) {
 		}
 		gtk_label_set_text(gui.info.vrate, text);
 		i = snprintf(text, sizeof(text) - 1, "Coördinates: ");
-		if (a->locations.last) {
-			double lon = a->locations.last->lon;
-			double lat = a->locations.last->lat;
+		if (a->locations.h.n) {
+			double lon = a->locations.lon[history_last(&a->locations.h)];
+			double lat = a->locations.lat[history_last(&a->locations.h)];
 			i += fill_angle_str(text + i, sizeof(text) - 1 - i, lat);
 			text[i++] = lat < 0 ? 'S' : 'N';
 			text[i++] = ' ';
@@ -188,8 +188,8 @@ update_info(const struct ms_aircraft_t *a) {
 		}
 		gtk_label_set_text(gui.info.coord, text);
 		i = snprintf(text, sizeof(text) - 1, "Speed: ");
-		if (a->velocities.last) {
-			double vel = a->velocities.last->speed;
+		if (a->velocities.h.n) {
+			double vel = a->velocities.speed[history_last(&a->velocities.h)];
 			snprintf(text + i, sizeof(text) - 1 - i,
 				 "%'.0f kt (%'.0f km/h)",
 				 vel, KT2KMPH(vel));
@@ -198,8 +198,8 @@ update_info(const struct ms_aircraft_t *a) {
 		}
 		gtk_label_set_text(gui.info.vel, text);
 		i = snprintf(text, sizeof(text) - 1, "Heading: ");
-		if (a->velocities.last) {
-			double h = a->velocities.last->heading;
+		if (a->velocities.h.n) {
+			double h = a->velocities.heading[history_last(&a->velocities.h)];
 			i += fill_angle_str(text + i, sizeof(text) - 1 - i, h);
 			snprintf(text + i, sizeof(text) - 1 - i,
 				 " (%s)", get_comp_point(h));
@@ -208,8 +208,8 @@ update_info(const struct ms_aircraft_t *a) {
 		}
 		gtk_label_set_text(gui.info.heading, text);
 		i = snprintf(text, sizeof(text) - 1, "Squawk: ");
-		if (a->squawks.last) {
-			uint16_t ID = a->squawks.last->ID;
+		if (a->squawks.h.n) {
+			uint16_t ID = a->squawks.ID[history_last(&a->squawks.h)];
 			snprintf(text + i, sizeof(text) - 1 - i,
 				 "%04o %s", ID, get_ID_desc(ID));
 		} else {
@@ -282,7 +282,7 @@ init_colors() {
 struct ms_ac_ext_t {
 	bool listed;
 	GtkTreeIter iter;
-	struct ms_ac_location_t const *last_loc;
+	size_t loc_seq; /* of the locations tracked so far */
 	struct ms_ac_track_t {
 		time_t time;
 		OsmGpsMapTrack *track;
@@ -319,22 +319,22 @@ update_store(struct ms_aircraft_t *a) {
 	if (a->name[0]) {
 		gtk_list_store_set(gui.store, iter, SC_NAME, a->name, -1);
 	}
-	if (a->altitudes.last) {
-		double alt = a->altitudes.last->alt;
+	if (a->altitudes.h.n) {
+		double alt = a->altitudes.alt[history_last(&a->altitudes.h)];
 		gtk_list_store_set(gui.store, iter, SC_ALT, lrint(alt), -1);
 	}
-	if (a->squawks.last) {
+	if (a->squawks.h.n) {
 		char s_squawk[5];
-		snprintf(s_squawk, 5, "%04o", a->squawks.last->ID);
+		snprintf(s_squawk, 5, "%04o", a->squawks.ID[history_last(&a->squawks.h)]);
 		s_squawk[4] = 0;
 		gtk_list_store_set(gui.store, iter, SC_SQUAWK, s_squawk, -1);
 	}
-	if (a->velocities.last) {
-		const char *head_str = get_comp_point(a->velocities.last->heading);
+	if (a->velocities.h.n) {
+		const char *head_str = get_comp_point(a->velocities.heading[history_last(&a->velocities.h)]);
 		gtk_list_store_set(gui.store, iter,
-			SC_VRATE, lrint(a->velocities.last->vrate),
-			SC_SPEED, lrint(a->velocities.last->speed),
-			SC_HEAD,  lrint(a->velocities.last->heading),
+			SC_VRATE, lrint(a->velocities.vrate[history_last(&a->velocities.h)]),
+			SC_SPEED, lrint(a->velocities.speed[history_last(&a->velocities.h)]),
+			SC_HEAD,  lrint(a->velocities.heading[history_last(&a->velocities.h)]),
 			SC_STR_HEAD, head_str,
 			-1);
 	}
@@ -433,7 +433,7 @@ set_track(struct ms_aircraft_t *a, bool selected) {
 
 
 static void
-add_loc_to_track(struct ms_aircraft_t *a, const struct ms_ac_location_t *loc) {
+add_loc_to_track(struct ms_aircraft_t *a, time_t time, double lat, double lon) {
 	struct ms_ac_ext_t *ext = a->ext;
 	struct ms_ac_track_t *track;
 	OsmGpsMapPoint p;
@@ -442,7 +442,7 @@ add_loc_to_track(struct ms_aircraft_t *a, const struct ms_ac_location_t *loc) {
 		return;
 	}
 
-	if (ext->head && ext->head->time && loc->time - ext->head->time < 300) {
+	if (ext->head && ext->head->time && time - ext->head->time < 300) {
 		track = ext->head;
 	} else {
 		allocs++;
@@ -458,26 +458,71 @@ add_loc_to_track(struct ms_aircraft_t *a, const struct ms_ac_location_t *loc) {
 		ext->head = track;
 	}
 
-	p.rlat = deg2rad(loc->lat);
-	p.rlon = deg2rad(loc->lon);
+	p.rlat = deg2rad(lat);
+	p.rlon = deg2rad(lon);
 	osm_gps_map_track_add_point(track->track, &p);
-	track->time = loc->time;
-	ext->last_loc = loc;
+	track->time = time;
 }
 
+/*
+ * Takes an aircraft retired by the library
+ * off the list and the map before it's gone.
+ */
+static void
+retire_aircraft(struct ms_aircraft_t *a, void *arg) {
+	struct ms_ac_ext_t *ext = a->ext;
 
-static int
-cat(const char *filename) {
-	static off_t offset = 0;
-	int err = 0;
-	struct ms_msg_t *msgs;
+	if (a == gui.sel) {
+		gui.sel = NULL;
+		update_info(NULL);
+	}
+
+	if (!ext)
+		return;
 
-	msgs = parse_file(filename, &offset, &aircrafts);
+	gtk_list_store_remove(gui.store, &ext->iter);
 
-	if (!msgs && errno) {
-		err -= 1;
+	while (ext->head) {
+		struct ms_ac_track_t *tmp = ext->head->next;
+
+		frees++;
+		if (ext->head->track) {
+			osm_gps_map_track_remove(gui.map, ext->head->track);
+			g_object_unref(ext->head->track);
+		}
+		free(ext->head);
+		ext->head = tmp;
+	}
+	free(ext);
+	a->ext = NULL;
+}
+
+static int
+cat(struct ms_reader_t *r) {
+	struct ms_msg_t *msgs = NULL;
+	struct ms_msg_t *last = NULL;
+	int ret;
+
+	/*
+	 * Rotation or truncation may have
+	 * left more to be read right away.
+	 */
+	do {
+		struct ms_msg_t *tmp;
+
+		if (!(tmp = parse_reader(r, aircrafts)))
+			continue;
+		if (last)
+			last->next = tmp;
+		else
+			msgs = tmp;
+		for (last = tmp; last->next; last = last->next)
+			;
+	} while ((ret = follow_reader(r)) > 0);
+
+	if (ret < 0) {
 		fprintf(stderr, "%s: Failed to parse file %s: %s\n",
-			argv0, filename ? filename : "stdin", strerror(errno));
+			argv0, gui.input, strerror(errno));
 	}
 
 	while (msgs) {
@@ -485,7 +530,8 @@ cat(const char *filename) {
 		struct ms_aircraft_t *a = msgs->aircraft;
 		if (a) {
 			struct ms_ac_ext_t *ext;
-			const struct ms_ac_location_t *l;
+			const struct ms_ac_locations_t *l = &a->locations;
+			struct ms_ac_cursor_t c;
 
 			if (a->ext) {
 				ext = a->ext;
@@ -496,78 +542,90 @@ cat(const char *filename) {
 				add_to_store(a);
 			}
 
-			if (a->locations.head) {
-				if (!ext->last_loc)
-					ext->last_loc = a->locations.head;
+			if (l->h.n) {
+				/*
+				 * Only the locations not yet tracked, of
+				 * those still kept, if the history is capped.
+				 */
+				size_t skip = 0;
+
+				if (l->h.seq - ext->loc_seq < l->h.n)
+					skip = l->h.n - (l->h.seq - ext->loc_seq);
 
-				for (l = ext->last_loc; l; l = l->next) {
-					add_loc_to_track(a, l);
+				for (history_begin(&l->h, &c); c.i < l->h.n; history_next(&l->h, &c)) {
+					if (c.i >= skip)
+						add_loc_to_track(a, c.time, l->lat[c.slot], l->lon[c.slot]);
 				}
-				if (ext->head && ext->head->track && a->velocities.last) {
-					double heading = a->velocities.last->heading;
+				ext->loc_seq = l->h.seq;
+				if (ext->head && ext->head->track && a->velocities.h.n) {
+					double heading = a->velocities.heading[history_last(&a->velocities.h)];
 					osm_gps_map_track_set_heading(ext->head->track, heading);
 				}
 			}
 
 			if (gui.message_cache && a->n_msg_aux > gui.message_cache && a->messages) {
-				struct ms_msg_t *tmp;
-				
-				tmp = a->messages->ac_next;
 				destroy_msg(a->messages);
-				a->messages = tmp;
-				--a->n_msg_aux;
 			}
 		}
 		msgs = tmp;
 	}
 
+	expire_aircrafts(aircrafts);
+
 	osm_gps_map_map_redraw_idle(gui.map);
 
-	return err ? -1 : 0;
+	return ret < 0 ? -1 : 0;
 }
 
 
+gboolean icb(GIOChannel *giofp, GIOCondition cond, gpointer data);
+
+static void
+watch_reader(struct ms_reader_t *r) {
+	GIOChannel *gioc;
+
+	gioc = g_io_channel_unix_new(reader_pollfd(r));
+	g_io_add_watch(gioc, G_IO_IN | G_IO_PRI | G_IO_HUP, &icb, r);
+	g_io_channel_unref(gioc);
+}
+
 gboolean
 icb(GIOChannel *giofp, GIOCondition cond, gpointer data) {
-	int fd = g_io_channel_unix_get_fd(giofp);
-	char ib[4 * sizeof(struct inotify_event)];
-	struct inotify_event *ev;
-	ssize_t len, i;
+	struct ms_reader_t *r = data;
+	int fd = reader_pollfd(r);
 
-	len = read(fd, ib, sizeof(ib));
+	if (wait_reader(r) < 0)
+		return false;
 
-	if (len < 0) {
-		if (errno == EINTR || errno == EAGAIN) {
-			return true;
-		}
+	if (cat(r) == -1)
 		return false;
-	}
 
-	for (i = 0; i < len; i += sizeof(struct inotify_event) + ev->len) {
-		ev = (struct inotify_event *)(ib + i);
-		if (ev->mask & ~IN_MODIFY) {
-			return false;
-		}
+	/*
+	 * The other end of a socket has closed,
+	 * or a listener has got a new client or
+	 * lost its last one.
+	 */
+	if (!r->follow)
+		return false;
+	if (reader_pollfd(r) != fd) {
+		watch_reader(r);
+		return false;
 	}
 
-	if (cat((char*)data) == -1)
-		return false;
-	else
-		return true;
+	return true;
 }
 
 void
 cleanup() {
+	struct ms_aircraft_t *a;
+
 	if (gui.store) {
 		g_object_unref(gui.store);
 	}
 
-	while (aircrafts) {
-		struct ms_aircraft_t *tmp;
-		
-		tmp = aircrafts->next;
-		if (aircrafts->ext) {
-			struct ms_ac_ext_t *ext = aircrafts->ext;
+	for (a = aircrafts->head; a; a = a->next) {
+		if (a->ext) {
+			struct ms_ac_ext_t *ext = a->ext;
 			while (ext->head) {
 				frees++;
 				struct ms_ac_track_t *tmp = ext->head->next;
@@ -576,11 +634,11 @@ cleanup() {
 				}
 				ext->head = tmp;
 			}
-			free(aircrafts->ext);
+			free(a->ext);
+			a->ext = NULL;
 		}
-		destroy_aircraft(aircrafts);
-		aircrafts = tmp;
 	}
+	destroy_ac_table(aircrafts);
 	gtk_main_quit();
 }
 
@@ -853,8 +911,8 @@ cb_do_filter(GtkWidget *w, gpointer user_data) {
 
 	gtk_tree_model_filter_refilter(gui.f);
 
-	for (a = aircrafts; a; a = a->next) {
-		struct ms_ac_ext_t *ext = aircrafts->ext;
+	for (a = aircrafts->head; a; a = a->next) {
+		struct ms_ac_ext_t *ext = a->ext;
 
 		if (!ext)
 			continue;
@@ -1127,11 +1185,15 @@ mk_win() {
 static void
 usage() {
 	printf("usage: %s [options] [file]\n", argv0);
+	printf("usage: %s [options] -c|-l addr\n", argv0);
 	printf("options:\n"
 	       " -m #:\tlisted aircrafts threshold, messages\n"
 	       " -s #:\tlisted aircrafts threshold, seconds\n"
 	       " -a #:\tactive aircrafts threshold, seconds\n"
 	       " -M #:\tmessage cache per aircraft\n"
+	       " -b:\tinput is in Beast binary format\n"
+	       " -c addr:\tread from socket addr, a path or [host:]port\n"
+	       " -l addr:\tlisten on socket addr for a client to read from\n"
 	       " -h:\tdo show home location\n"
 	       " -H:\tdo not show home location\n"
 	       " -p:\tdo plot previous tracks\n"
@@ -1145,10 +1207,10 @@ usage() {
 int
 main(int argc, char *argv[]) {
 	int err = 0;
-	int ifd = -1;
-	int iwfd = -1;
+	struct ms_reader_t *r;
 	char *filename;
-	GIOChannel *gioc;
+	char *sock_addr = NULL;
+	bool sock_listen = false;
 	double dpi;
 
 	gtk_init(&argc, &argv);
@@ -1170,6 +1232,14 @@ main(int argc, char *argv[]) {
 	gui.message_cache = default_message_cache;
 	gui.show_home = default_show_home;
 
+	aircrafts = mk_ac_table();
+	if (aircrafts) {
+		aircrafts->history_cap = default_history_cap;
+		aircrafts->ttl = default_aircraft_ttl;
+		aircrafts->budget = 1024 * 1024 * default_memory_budget;
+		aircrafts->retire = retire_aircraft;
+	}
+
 	ARGBEGIN {
 	case 's':
 		gui.filter.seen_list = atoi(EARGF(usage()));
@@ -1204,13 +1274,24 @@ main(int argc, char *argv[]) {
 	case 'S':
 		gui.map_source = atoi(EARGF(usage()));
 		break;
+	case 'b':
+		gui.format = FORMAT_BEAST;
+		break;
+	case 'c':
+		sock_addr = EARGF(usage());
+		sock_listen = false;
+		break;
+	case 'l':
+		sock_addr = EARGF(usage());
+		sock_listen = true;
+		break;
 	default:
 		usage();
 	} ARGEND;
 
 	if (!argc)
 		filename = (char *)default_outfile;
-	else if (argc == 1)
+	else if (argc == 1 && !sock_addr)
 		filename = argv[0];
 	else
 		usage();
@@ -1220,27 +1301,41 @@ main(int argc, char *argv[]) {
 		return 1;
 	}
 
-	if (init_inotify(filename, &ifd, &iwfd) < 0) {
-		return 1;
+	if (sock_addr) {
+		gui.input = sock_addr;
+		if (!(r = mk_sock_reader(sock_addr, sock_listen))) {
+			fprintf(stderr, "%s: FATAL: Failed to %s %s: %s\n", argv0,
+			        sock_listen ? "listen on" : "connect to",
+			        sock_addr, strerror(errno));
+			return 1;
+		}
+	} else {
+		gui.input = filename;
+		if (!(r = mk_tailer(filename, 0))) {
+			fprintf(stderr, "%s: FATAL: Failed to follow %s: %s\n",
+			        argv0, filename, strerror(errno));
+			return 1;
+		}
 	}
+	r->format = gui.format;
 
 	mk_win();
 
 	dpi = gdk_screen_get_resolution(gdk_screen_get_default());
 	gui.scale = (dpi * 39.37) * (6378136.6 * (2 * M_PI)) / 256.0;
 
-	gioc = g_io_channel_unix_new(ifd);
-	g_io_add_watch(gioc, G_IO_IN | G_IO_PRI, &icb, filename);
-
-	if (cat(filename) < 0)
+	if (cat(r) < 0)
 		err -= 1;
 
+	watch_reader(r);
+
 	gtk_main();
 
-	if (ifd >= 0)
-		close(ifd);
-	if (iwfd >= 0)
-		close(iwfd);
+	if (destroy_reader(r) < 0) {
+		fprintf(stderr, "%s: ERROR: Failed to read %s: %s\n",
+		        argv0, gui.input, strerror(errno));
+		err -= 1;
+	}
 
 /*
 	for (i = 0; i < COL_COUNT; ++i)
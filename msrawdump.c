@@ -46,7 +46,7 @@
 
 #include <arg.h>
 
-#include "inot.h"
+#include "reader.h"
 
 #define CONF_MSFILES
 #include "config.h"
@@ -59,14 +59,10 @@ usage() {
 
 int
 main(int argc, char *argv[]) {
-	int err = 0;
 	const char *filename = default_outfile;
-	int ifd = -1;
-	int iwfd = -1;
-	size_t len = 0;
-	char *line = NULL;
-	off_t offset = 0;
+	struct ms_reader_t *r;
 	struct stat st;
+	int err = 0;
 
 	ARGBEGIN {
 	case 'f':
@@ -79,62 +75,35 @@ main(int argc, char *argv[]) {
 		        argv0, filename, strerror(errno));
 		exit(1);
 	}
-	offset = st.st_size;
 
-	if (init_inotify(filename, &ifd, &iwfd)) {
-		fprintf(stderr, "%s: FATAL: inotify %s: %s\n",
+	if (!(r = mk_tailer(filename, st.st_size))) {
+		fprintf(stderr, "%s: FATAL: follow %s: %s\n",
 		        argv0, filename, strerror(errno));
 		exit(1);
 	}
 
 	while (1) {
-		ssize_t bytes;
-		FILE *fp;
-
-		if (!(fp = fopen(filename, "r"))
-		|| fseek(fp, offset, SEEK_SET) == -1) { 
-			err += 1;
-			break;
+		const char *line;
+		ssize_t len;
+		int ret;
+
+		while ((len = read_line(r, &line)) >= 0) {
+			if (len == 37 || len == 44)
+				printf("*%.14s;\n", line + 16);
+			else if (len == 51 || len == 58)
+				printf("*%.28s;\n", line + 16);
 		}
+		fflush(stdout);
 
-		while ((bytes = getline(&line, &len, fp)) > 0) {
-			if (bytes == 38)
-				line[30] = 0;
-			else if (bytes == 52)
-				line[44] = 0;
-			else
-				continue;
-
-			printf("*%s;\n", line + 16);
-		}
-
-		offset = ftell(fp);
-		fclose(fp);
-
-		if (wait_for_inotify(ifd) < 0) {
+		if ((ret = follow_reader(r)) > 0)
+			continue;
+		if (ret < 0 || wait_reader(r) < 0) {
 			err += 1;
 			break;
 		}
 	}
 
-	if (line)
-		free(line);
-
-	if (ifd != -1)
-		close(ifd);
-	if (iwfd != -1)
-		close(iwfd);
-
+	destroy_reader(r);
 
 	return err ? 1 : 0;
 }
-
-
-
-
-
-
-
-
-
-
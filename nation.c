@@ -17,6 +17,15 @@
 #include "nation.h"
 #include "flags.h"
 
+/*
+ * Addresses are looked up 4096 at a time, by their top 12
+ * bits, and in groups of 1024 where allocations are finer.
+ */
+#define NATION_TOP_SHIFT  12
+#define NATION_FINE_SHIFT 10
+#define NATION_FINE_BITS  (NATION_TOP_SHIFT - NATION_FINE_SHIFT)
+#define NATION_FINE       0x8000
+
 /*
  * ICAO address allocation
  * [4] Table 9-1
@@ -228,45 +237,58 @@ static const struct ms_nation_t states[] = {
 	{ 0x000000, 0x000000, "unk", "Unknown state", (void*)flag_unk },
 };
 
-const struct ms_nation_t *
-icao_addr_to_nation(uint32_t addr) {
-	uint32_t len, i;
+/*
+ * Index of the state of addr, in top, indexed by the top bits
+ * of the address, or, where the allocations are finer than
+ * that, in the group of fine entries it points out.
+ */
+static unsigned
+nation_index(const uint16_t *top, const uint8_t *fine, uint32_t addr) {
+	unsigned i = top[(addr & 0xFFFFFF) >> NATION_TOP_SHIFT];
+
+	if (i & NATION_FINE)
+		i = fine[((i & ~NATION_FINE) << NATION_FINE_BITS)
+		       | ((addr >> NATION_FINE_SHIFT) & ((1 << NATION_FINE_BITS) - 1))];
+	return i;
+}
+
+#ifdef MK_NATION_TBL
+/*
+ * The first state whose allocation addr is in, by a scan of all
+ * of them. Only used by mknation, to generate nation_tbl.h.
+ */
+static unsigned
+scan_states(uint32_t addr) {
+	unsigned len, i;
 
 	len = sizeof(states) / sizeof(states[0]);
 
 	for (i = 0; i < len; ++i) {
 		if ((addr & states[i].mask) == states[i].code) {
-			return states + i;
+			return i;
 		}
 	}
 	/*
 	 * NOTREACHED
 	 * Last state will match everything
 	 */
-	return states + len - 1;
+	return len - 1;
+}
+#else
+#include "nation_tbl.h"
+
+const struct ms_nation_t *
+icao_addr_to_nation(uint32_t addr) {
+	return states + nation_index(nation_top, nation_fine, addr);
 }
 
 const char *
 icao_addr_to_state(uint32_t addr) {
-	uint32_t i;
-
-	for (i = 0; i < sizeof(states) / sizeof(states[0]); ++i) {
-		if ((addr & states[i].mask) == states[i].code) {
-			return states[i].name;
-		}
-	}
-	return 0;
+	return icao_addr_to_nation(addr)->name;
 }
 
 const char *
 icao_addr_to_iso3(uint32_t addr) {
-	uint32_t i;
-
-	for (i = 0; i < sizeof(states) / sizeof(states[0]); ++i) {
-		if ((addr & states[i].mask) == states[i].code) {
-			return states[i].iso3;
-		}
-	}
-	return 0; 
-
+	return icao_addr_to_nation(addr)->iso3;
 }
+#endif
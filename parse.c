@@ -22,10 +22,24 @@
 #include <errno.h>
 #include <ctype.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "message.h"
 #include "parse.h"
+#include "reader.h"
+#include "hex.h"
+#include "beast.h"
+#include "archive.h"
+#include "merge.h"
+#include "dedup.h"
+#include "arena.h"
 #include "util.h"
+#include "crc.h"
+
+/*
+ * Least amount of input, in bytes, worth a thread of its own.
+ */
+#define PARSE_CHUNK_MIN (256 * 1024)
 
 static bool
 tok_is_df(const char *tok, size_t len) {
@@ -52,13 +66,6 @@ tok_is_time(const char *tok, size_t len) {
 	return is_type_of_len(tok, len, isdigit);
 }
 
-static bool
-tok_is_msg(const char *tok, size_t len) {
-	if (len != 14 && len != 28)
-		return false;
-	return is_type_of_len(tok, len, isxdigit);
-}
-
 static bool
 tok_is_icao_addr(const char *tok, size_t len) {
 	if (len != 6)
@@ -68,10 +75,15 @@ tok_is_icao_addr(const char *tok, size_t len) {
 
 static bool
 tok_is_dump_msg(const char *tok, size_t len) {
-	if (len > 2 && tok[0] == '*' && tok[len - 1] == ';') {
-		return tok_is_msg(tok + 1, len - 2);
-	}
-	return false;
+	return len > 2 && tok[0] == '*' && tok[len - 1] == ';';
+}
+
+/*
+ * AVR format with MLAT timestamp, @<12 hex digits><message>;
+ */
+static bool
+tok_is_avr_msg(const char *tok, size_t len) {
+	return len > 14 && tok[0] == '@' && tok[len - 1] == ';';
 }
 
 static uint8_t
@@ -82,31 +94,103 @@ strtohex(uint8_t x) {
 	return 0xFF;
 }
 
-struct ms_msg_t *
-line_to_msg(const char *orig_line) {
-	char *tok;
-	char *sep;
-	char *line;
+static time_t
+strtotime(const char *tok, size_t len) {
+	time_t ret = 0;
+	size_t i;
+
+	for (i = 0; i < len; ++i)
+		ret = 10 * ret + (tok[i] - '0');
+	return ret;
+}
+
+/*
+ * Fast path for the fixed layout written by rtl-modes,
+ * DF##:<10 digit time>:<14 or 28 hex digits>:<6 hex digits>
+ * optionally followed by :<6 hex digits> of syndrome, which
+ * is then taken as is, rather than computed again.
+ * Returns -1 if buf doesn't strictly follow it.
+ */
+static int
+rtl_modes_to_frame(const char *buf, size_t buflen, struct ms_frame_t *frame) {
+	uint8_t addr[3];
+	uint8_t syn[3];
+	bool has_syn = false;
+	size_t len;
+	size_t i;
+
+	switch (buflen) {
+	case 44:
+		has_syn = true;
+		/* FALLTHROUGH */
+	case 37:
+		len = 7;
+		break;
+	case 58:
+		has_syn = true;
+		/* FALLTHROUGH */
+	case 51:
+		len = 14;
+		break;
+	default:
+		return -1;
+	}
+
+	if (!tok_is_df(buf, 4) || buf[4] != ':' || buf[15] != ':' || buf[16 + 2 * len] != ':')
+		return -1;
+	if (has_syn && buf[23 + 2 * len] != ':')
+		return -1;
+
+	for (i = 5; i < 15; ++i)
+		if (buf[i] < '0' || buf[i] > '9')
+			return -1;
+
+	if (hex_to_bytes(buf + 16, frame->raw, len) < 0
+	 || hex_to_bytes(buf + 17 + 2 * len, addr, 3) < 0)
+		return -1;
+	if (has_syn && hex_to_bytes(buf + 24 + 2 * len, syn, 3) < 0)
+		return -1;
+
+	frame->len = len;
+	frame->mlat = 0;
+	frame->signal = 0;
+	frame->time = strtotime(buf + 5, 10);
+	frame->addr = (addr[0] << 16) | (addr[1] << 8) | addr[2];
+	frame->syn = has_syn ? (uint32_t)((syn[0] << 16) | (syn[1] << 8) | syn[2]) : 0xFF000000;
+
+	return 0;
+}
+
+/*
+ * Any other colon separated layout, fields
+ * recognised by their contents.
+ */
+static int
+tokens_to_frame(const char *buf, size_t buflen, struct ms_frame_t *frame) {
+	const char *tok;
+	const char *end = buf + buflen;
+	const char *sep;
 	size_t n;
-	struct ms_msg_t *msg = NULL;
-	bool have_addr = false;;
+	bool have_addr = false;
 	bool have_time = false;
+	bool have_raw = false;
 
-	uint8_t *raw = NULL;
-	uint8_t msg_type;
-	time_t msg_time = 0;
-	size_t msg_len = 0;
-	uint32_t addr = 0xFF000000;
-
-	line = strdup(orig_line);
+	frame->time = 0;
+	frame->mlat = 0;
+	frame->signal = 0;
+	frame->len = 0;
+	frame->addr = 0xFF000000;
+	frame->syn = 0xFF000000;
 
-	for (tok = line, n = 0; tok; ++n, tok = sep ? sep + 1 : NULL) {
+	for (tok = buf, n = 0; tok; ++n, tok = sep ? sep + 1 : NULL) {
 		size_t len;
 
-		if ((sep = strchr(tok, ':')))
-			*sep = '\0';
+		if ((sep = memchr(tok, ':', end - tok)))
+			len = sep - tok;
+		else
+			len = end - tok;
 
-		if (!(len = strlen(tok))) {
+		if (!len) {
 			continue;
 		}
 
@@ -116,18 +200,18 @@ line_to_msg(const char *orig_line) {
 
 		if (!have_time && tok_is_time(tok, len)) {
 			have_time = true;
-			msg_time = atol(tok);
+			frame->time = strtotime(tok, len);
 			continue;
 		}
 
 		if (!have_addr && tok_is_icao_addr(tok, len)) {
 			have_addr = true;
-			addr = (strtohex(tok[0]) << 20)
-			     | (strtohex(tok[1]) << 16)
-			     | (strtohex(tok[2]) << 12)
-			     | (strtohex(tok[3]) << 8)
-			     | (strtohex(tok[4]) << 4)
-			     | (strtohex(tok[5]) << 0);
+			frame->addr = (strtohex(tok[0]) << 20)
+			            | (strtohex(tok[1]) << 16)
+			            | (strtohex(tok[2]) << 12)
+			            | (strtohex(tok[3]) << 8)
+			            | (strtohex(tok[4]) << 4)
+			            | (strtohex(tok[5]) << 0);
 			continue;
 		}
 
@@ -135,114 +219,612 @@ line_to_msg(const char *orig_line) {
 		if (tok_is_dump_msg(tok, len)) {
 			tok += 1;
 			len -= 2;
+		} else if (tok_is_avr_msg(tok, len)) {
+			uint8_t ts[6];
+
+			if (hex_to_bytes(tok + 1, ts, 6) == 0) {
+				frame->mlat = ((uint64_t)ts[0] << 40)
+				            | ((uint64_t)ts[1] << 32)
+				            | ((uint64_t)ts[2] << 24)
+				            | ((uint64_t)ts[3] << 16)
+				            | ((uint64_t)ts[4] <<  8)
+				            | ((uint64_t)ts[5] <<  0);
+			}
+			tok += 13;
+			len -= 14;
+		}
+		if (!have_raw && (len == 14 || len == 28)
+		 && hex_to_bytes(tok, frame->raw, len / 2) == 0) {
+			have_raw = true;
+			frame->len = len / 2;
 		}
-		if (!raw && tok_is_msg(tok, len)) {
-			char *src = tok;
-			uint8_t *dst;
-			size_t i;
-
-			msg_len = len / 2;
-			raw = malloc(msg_len);
-			dst = raw;
 
+	}
 
-			for (i = 0; i < msg_len; ++i) {
-				uint8_t a, b;
+	return have_raw ? 0 : -1;
+}
 
-				a = strtohex(*src++);
-				b = strtohex(*src++);
+/*
+ * Tokenises buf, which needn't be terminated, in place
+ * and fills in frame. Returns -1 unless a message of
+ * valid length for its DF was found.
+ */
+int
+buf_to_frame(const char *buf, size_t len, struct ms_frame_t *frame) {
+	uint8_t msg_type;
 
-				dst[i] = (a << 4) | (b);
-			}
-		}
+	if (rtl_modes_to_frame(buf, len, frame) < 0
+	 && tokens_to_frame(buf, len, frame) < 0)
+		return -1;
 
+	msg_type = frame->raw[0] >> 3;
+	
+	if (df_to_len(msg_type) != (ssize_t)frame->len) {
+		return -1;
 	}
 
-	if (!raw) {
-		free(line);
-		return NULL;
-	}
+	return 0;
+}
 
-	msg_type = raw[0] >> 3;
-	
-	if (df_to_len(msg_type) != (ssize_t)msg_len) {
-		free(raw);
-		free(line);
-		return NULL;
-	}
+struct ms_msg_t *
+buf_to_msg(const char *buf, size_t len) {
+	struct ms_frame_t frame;
 
-	msg = mk_msg(raw, msg_time, addr);
+	if (buf_to_frame(buf, len, &frame) < 0)
+		return NULL;
 
-	free(raw);
-	free(line);
-	return msg;
+	return mk_msg_syn(frame.raw, frame.time, frame.addr, frame.syn);
 }
 
 struct ms_msg_t *
-parse_file(const char *filename, off_t *offset, struct ms_aircraft_t **aircrafts) {
-	struct ms_msg_t *msgs = NULL;
-	struct ms_msg_t *last = NULL;
-	FILE *fp = NULL;
-	size_t len = 0;
-	char *line = NULL;
-	ssize_t bytes;
+line_to_msg(const char *line) {
+	return buf_to_msg(line, strlen(line));
+}
 
-	errno = 0;
+/*
+ * The MLAT timestamps of Beast and AVR input are 12 MHz
+ * counters from an arbitrary epoch, so the first one seen
+ * is taken to be now.
+ */
+static void
+mlat_to_time(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	if (frame->time || !frame->mlat)
+		return;
+
+	if (!r->time_base || frame->mlat < r->mlat_base) {
+		r->mlat_base = frame->mlat;
+		r->time_base = time(NULL);
+	}
+	frame->time = r->time_base + (frame->mlat - r->mlat_base) / 12000000;
+}
 
-	if (filename) {
-		if (!(fp = fopen(filename, "r"))) {
-			return NULL;
+static int
+read_beast(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	for (;;) {
+		const uint8_t *buf = (const uint8_t *)r->buf + r->pos;
+		ssize_t n;
+
+		if (!(n = beast_to_frame(buf, r->len - r->pos, frame))) {
+			/*
+			 * A truncated frame at the end is left
+			 * unread, to be picked up when following.
+			 */
+			if (fill_reader(r) > 0)
+				continue;
+			return 0;
 		}
-		if (offset && fseek(fp, *offset, SEEK_SET) == -1) {
-			return NULL;
+
+		r->pos += n;
+		if (frame->len)
+			return 1;
+	}
+}
+
+static int
+read_archive(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	for (;;) {
+		const uint8_t *rec = (const uint8_t *)r->buf + r->pos;
+
+		if (r->len - r->pos < ARCHIVE_RECLEN) {
+			/* As for Beast, leave partial records */
+			if (fill_reader(r) > 0)
+				continue;
+			return 0;
 		}
+
+		r->pos += ARCHIVE_RECLEN;
+		if (record_to_frame(rec, frame) == 0)
+			return 1;
+	}
+}
+
+static int
+read_text(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	const char *line;
+	ssize_t len;
+
+	while ((len = read_line(r, &line)) >= 0) {
+		if (buf_to_frame(line, len, frame) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+static void
+detect_format(struct ms_reader_t *r) {
+	while (r->len - r->pos < ARCHIVE_HDRLEN && fill_reader(r) > 0)
+		;
+	/*
+	 * Nothing to tell from yet.
+	 */
+	if (r->pos == r->len && r->follow && !r->eof)
+		return;
+
+	if (is_archive_header((const uint8_t *)r->buf + r->pos, r->len - r->pos)) {
+		r->format = FORMAT_ARCHIVE;
+		r->pos += ARCHIVE_HDRLEN;
+	} else if (r->pos < r->len && r->buf[r->pos] == BEAST_ESC) {
+		r->format = FORMAT_BEAST;
 	} else {
-		fp = stdin;
+		r->format = FORMAT_TEXT;
 	}
+}
 
-	while ((bytes = getline(&line, &len, fp)) > 0) {
-		struct ms_msg_t *msg;
+/*
+ * Reads the next message, of any of the formats, from r.
+ * Returns 1 if frame was filled in, 0 at end of input.
+ */
+int
+read_frame(struct ms_reader_t *r, struct ms_frame_t *frame) {
+	int ret;
+
+	if (r->format == FORMAT_AUTO)
+		detect_format(r);
+	if (r->format == FORMAT_AUTO)
+		return 0;
+
+	if (r->end && reader_offset(r) >= r->end)
+		return 0;
+
+	switch (r->format) {
+	case FORMAT_ARCHIVE:
+		ret = read_archive(r, frame);
+		break;
+	case FORMAT_BEAST:
+		ret = read_beast(r, frame);
+		break;
+	case FORMAT_MERGED:
+		ret = read_merged(r, frame);
+		break;
+	default:
+		ret = read_text(r, frame);
+		break;
+	}
 
-		if (line[bytes - 1] == '\n')
-			line[bytes - 1] = '\0';
+	if (ret > 0)
+		mlat_to_time(r, frame);
+	return ret;
+}
+
+/*
+ * The address of the message, as mk_msg would have it, but
+ * without decoding it. The syndrome is kept in the frame,
+ * if it has to be computed to get at the AP field.
+ */
+uint32_t
+frame_addr(struct ms_frame_t *frame) {
+	unsigned DF = frame->raw[0] >> 3;
+	size_t len = DF > 11 ? 14 : 7;
+
+	if (!(frame->addr & 0xFF000000))
+		return frame->addr;
+
+	switch (DF) {
+	case 11:
+	case 17:
+	case 18:
+	case 19:
+		/* AA */
+		return frame->raw[1] << 16 | frame->raw[2] << 8 | frame->raw[3];
+	case 0:
+	case 4:
+	case 5:
+	case 16:
+	case 20:
+	case 21:
+		break;
+	default:
+		if (DF < 24)
+			return 0;
+	}
+
+	/* AP */
+	if (frame->syn & 0xFF000000)
+		frame->syn = crc_syndrome(frame->raw, len);
+	return frame->syn & 0x00FFFFFF;
+}
+
+uint8_t *
+mk_addr_filter() {
+	return calloc(1, ADDR_FILTER_LEN);
+}
+
+void
+add_addr_filter(uint8_t *filter, uint32_t addr) {
+	addr &= 0x00FFFFFF;
+	filter[addr >> 3] |= 1 << (addr & 7);
+}
+
+/*
+ * Frames are filtered by time and address, and duplicates
+ * dropped, before anything's allocated or decoded.
+ */
+static bool
+wanted(const struct ms_reader_t *r, struct ms_frame_t *frame) {
+	if (frame->time < r->from || (r->to && frame->time >= r->to))
+		return false;
+
+	if (r->addrs) {
+		uint32_t addr = frame_addr(frame);
+
+		if (!(r->addrs[addr >> 3] & (1 << (addr & 7))))
+			return false;
+	}
+
+	if (r->dedup && is_duplicate(r->dedup, frame))
+		return false;
+
+	return true;
+}
 
-		if ((msg = line_to_msg(line))) {
-			if (aircrafts) {
-				struct ms_aircraft_t *a;
+struct parse_chunk_t {
+	pthread_t thread;
+	bool joinable;
+	struct ms_reader_t r;
+	off_t stop; /* at this offset, if not 0 */
+	bool kept; /* past the batch, so not in an arena */
+	struct ms_msg_t *head;
+	struct ms_msg_t *tail;
+};
 
-				if ((a = find_aircraft(msg->addr, *aircrafts))) {
-					update_aircraft(a, msg);
-				} else {
-					a = mk_aircraft(msg->addr);
-					update_aircraft(a, msg);
-					a->next = *aircrafts;
-					*aircrafts = a;
-				}
+/*
+ * Syndromes of the frames that don't have one yet, as
+ * mk_msg would compute them, all at once. Frames from
+ * archives already have theirs.
+ */
+static void
+frame_syndromes(struct ms_frame_t *frames, size_t n) {
+	const uint8_t *msgs[CRC_BATCH];
+	size_t lens[CRC_BATCH];
+	uint32_t syns[CRC_BATCH];
+	size_t idx[CRC_BATCH];
+	size_t i, m = 0;
+
+	for (i = 0; i < n; ++i) {
+		if (!(frames[i].syn & 0xFF000000))
+			continue;
+		msgs[m] = frames[i].raw;
+		lens[m] = frames[i].raw[0] >> 3 > 11 ? 14 : 7;
+		idx[m++] = i;
+	}
+
+	crc_syndromes(msgs, lens, syns, m);
+	for (i = 0; i < m; ++i)
+		frames[idx[i]].syn = syns[i];
+}
+
+static void *
+parse_chunk(void *arg) {
+	struct parse_chunk_t *c = arg;
+	struct ms_arena_t *arena;
+	struct ms_frame_t frames[CRC_BATCH];
+	size_t i, n;
+	bool done = false;
+
+	/*
+	 * Each chunk has an arena of its own, so threads
+	 * needn't share one. It's freed with its last message.
+	 * Messages kept past the batch are allocated one by
+	 * one instead, so that a few of them don't keep it all.
+	 */
+	arena = c->kept ? NULL : mk_arena();
+	c->head = c->tail = NULL;
+
+	/*
+	 * The frames wanted are gathered a block at a time,
+	 * so that their syndromes can be computed together,
+	 * and only theirs.
+	 */
+	while (!done) {
+		for (n = 0; n < CRC_BATCH; ) {
+			if (read_frame(&c->r, &frames[n]) <= 0) {
+				done = true;
+				break;
 			}
+			if (wanted(&c->r, &frames[n]))
+				++n;
+			if (c->stop && reader_offset(&c->r) >= c->stop) {
+				done = true;
+				break;
+			}
+		}
+		frame_syndromes(frames, n);
+
+		for (i = 0; i < n; ++i) {
+			struct ms_msg_t *msg;
+
+			msg = mk_msg_arena(arena, frames[i].raw, frames[i].time,
+			                   frames[i].addr, frames[i].syn);
 			msg->next = NULL;
-			if (last) {
-				last->next = msg;
+			if (c->tail) {
+				c->tail->next = msg;
 			} else {
-				msgs = msg;
+				c->head = msg;
 			}
-			last = msg;
+			c->tail = msg;
+		}
+	}
+
+	if (arena)
+		release_arena(arena);
+	return NULL;
+}
+
+/*
+ * First line or record boundary at or after end.
+ */
+static size_t
+boundary(const struct ms_reader_t *r, size_t end) {
+	const char *nl;
+
+	if (end >= r->len)
+		return r->len;
+
+	if (r->format == FORMAT_ARCHIVE) {
+		end += (ARCHIVE_RECLEN - (end - r->pos) % ARCHIVE_RECLEN) % ARCHIVE_RECLEN;
+		return end < r->len ? end : r->len;
+	}
+
+	nl = memchr(r->buf + end, '\n', r->len - end);
+	return nl ? (size_t)(nl - r->buf) + 1 : r->len;
+}
+
+/*
+ * Splits what's left of a mapped file into n chunks,
+ * and parses them in parallel. The messages are
+ * returned in file order.
+ */
+static struct ms_msg_t *
+parse_parallel(struct ms_reader_t *r, size_t n, bool kept) {
+	struct parse_chunk_t *chunks;
+	struct ms_msg_t *msgs = NULL;
+	struct ms_msg_t *last = NULL;
+	size_t size = r->len - r->pos;
+	size_t pos = r->pos;
+	size_t i;
+
+	/*
+	 * Pick the MLAT clock base from the first message,
+	 * rather than from the first of each chunk.
+	 */
+	if (!r->time_base) {
+		struct ms_reader_t peek = *r;
+		struct ms_frame_t frame;
+
+		if (read_frame(&peek, &frame) > 0) {
+			r->mlat_base = peek.mlat_base;
+			r->time_base = peek.time_base;
+		}
+	}
+
+	chunks = calloc(n, sizeof(struct parse_chunk_t));
+
+	for (i = 0; i < n; ++i) {
+		size_t end = boundary(r, r->pos + size / n * (i + 1));
+
+		if (i == n - 1)
+			end = r->len;
+		if (end < pos)
+			end = pos;
+
+		chunks[i].r = *r;
+		chunks[i].r.pos = pos;
+		chunks[i].r.len = end;
+		chunks[i].kept = kept;
+		pos = end;
+	}
+
+	for (i = 1; i < n; ++i) {
+		if (pthread_create(&chunks[i].thread, NULL, parse_chunk, &chunks[i]) == 0)
+			chunks[i].joinable = true;
+		else
+			parse_chunk(&chunks[i]);
+	}
+	parse_chunk(&chunks[0]);
+
+	for (i = 0; i < n; ++i) {
+		if (chunks[i].joinable)
+			pthread_join(chunks[i].thread, NULL);
+		if (!chunks[i].head)
+			continue;
+		if (last) {
+			last->next = chunks[i].head;
+		} else {
+			msgs = chunks[i].head;
+		}
+		last = chunks[i].tail;
+	}
+
+	/*
+	 * A partial record at the end is left
+	 * unread, as when parsing serially.
+	 */
+	r->pos = chunks[n - 1].r.pos;
+	r->mlat_base = chunks[n - 1].r.mlat_base;
+	r->time_base = chunks[n - 1].r.time_base;
+
+	free(chunks);
+	return msgs;
+}
+
+/*
+ * Parses about size bytes of input, or all of it if
+ * size is 0, on r->threads threads where possible.
+ * kept tells if the messages outlive the batch.
+ */
+static struct ms_msg_t *
+parse_batch(struct ms_reader_t *r, size_t size, bool kept) {
+	struct parse_chunk_t c;
+	size_t n = 1;
+
+	if (r->format == FORMAT_AUTO)
+		detect_format(r);
+
+	/*
+	 * Beast frames can't be told apart from their
+	 * contents, so there's no place to split them.
+	 * Duplicates are only told in order.
+	 */
+	if (r->threads > 1 && r->mapped && r->format != FORMAT_BEAST && !r->dedup) {
+		struct ms_reader_t w = *r;
+		struct ms_msg_t *msgs;
+
+		if (size)
+			w.len = boundary(r, r->pos + size);
+		if (r->end && r->end - r->offset < (off_t)w.len)
+			w.len = r->end > reader_offset(r) ? (size_t)(r->end - r->offset) : r->pos;
+
+		n = (w.len - w.pos) / PARSE_CHUNK_MIN;
+		if (n > r->threads)
+			n = r->threads;
+
+		if (n > 1) {
+			msgs = parse_parallel(&w, n, kept);
+			r->pos = w.pos;
+			r->mlat_base = w.mlat_base;
+			r->time_base = w.time_base;
+			return msgs;
 		}
+	}
 
+	memset(&c, 0, sizeof(c));
+	c.r = *r;
+	c.kept = kept;
+	if (size)
+		c.stop = reader_offset(r) + size;
+	parse_chunk(&c);
+	*r = c.r;
+
+	return c.head;
+}
+
+/*
+ * Aircrafts are updated in order,
+ * regardless of how they were parsed.
+ */
+static void
+update_aircrafts(const struct ms_reader_t *r, struct ms_msg_t *msgs,
+                 struct ms_ac_table_t *aircrafts) {
+	struct ms_msg_t *msg;
+
+	for (msg = msgs; aircrafts && msg; msg = msg->next) {
+		struct ms_aircraft_t *a;
+
+		if (msg->time > aircrafts->now)
+			aircrafts->now = msg->time;
+		if (!(a = find_aircraft(msg->addr, aircrafts)))
+			a = add_aircraft(aircrafts, msg->addr);
+		if (r->untracked)
+			count_aircraft(a, msg);
+		else
+			update_aircraft(a, msg);
 	}
+}
+
+struct ms_msg_t *
+parse_reader(struct ms_reader_t *r, struct ms_ac_table_t *aircrafts) {
+	struct ms_msg_t *msgs;
+
+	msgs = parse_batch(r, 0, true);
+	update_aircrafts(r, msgs, aircrafts);
 
 	/*
-	 * TODO: Check for errors on fp, without
+	 * TODO: Check for read errors, without
 	 * having to free msgs and returning NULL.
 	 */
 
-	free(line);
+	return msgs;
+}
 
-	if (fp != stdin) {
-		if (offset)
-			*offset = ftell(fp);
+/*
+ * Parses r in batches of r->batch bytes of input, or
+ * all of it at once if 0, and hands each batch of
+ * messages to cb, after updating the aircrafts.
+ * The messages are destroyed when cb returns, so
+ * only the aircrafts' derived history is kept, and
+ * the aircrafts are then expired, see expire_aircrafts.
+ * Returns -1 if cb does, otherwise 0.
+ */
+int
+parse_stream(struct ms_reader_t *r, struct ms_ac_table_t *aircrafts,
+             int (*cb)(struct ms_msg_t *, void *), void *arg) {
+	for (;;) {
+		off_t offset = reader_offset(r);
+		struct ms_msg_t *msgs;
+		int ret;
+
+		msgs = parse_batch(r, r->batch, false);
+
+		if (!msgs) {
+			if (reader_offset(r) == offset)
+				return 0;
+			continue;
+		}
+
+		update_aircrafts(r, msgs, aircrafts);
+
+		if (r->batch)
+			discard_read(r);
+
+		ret = cb(msgs, arg);
 
-		fclose(fp);
+		while (msgs) {
+			struct ms_msg_t *tmp = msgs->next;
+			destroy_msg(msgs);
+			msgs = tmp;
+		}
+
+		if (aircrafts)
+			expire_aircrafts(aircrafts);
+
+		if (ret < 0)
+			return -1;
 	}
+}
+
+struct ms_msg_t *
+parse_file(const char *filename, off_t *offset, struct ms_ac_table_t *aircrafts) {
+	struct ms_msg_t *msgs;
+	struct ms_reader_t *r;
+
+	errno = 0;
+
+	if (!(r = mk_reader(filename, offset ? *offset : 0))) {
+		return NULL;
+	}
+
+	errno = 0;
+
+	msgs = parse_reader(r, aircrafts);
+
+	if (filename && offset)
+		*offset = reader_offset(r);
+
+	/*
+	 * What was read is returned even if the input turns
+	 * out to be corrupt or truncated, with errno set to EIO.
+	 */
+	destroy_reader(r);
 
 	return msgs;
 }
@@ -3,7 +3,36 @@
 
 #include "aircraft.h"
 #include "message.h"
+#include "reader.h"
 
+/*
+ * A raw message as found in the input,
+ * before it's been made into a ms_msg_t.
+ */
+struct ms_frame_t {
+	time_t time;
+	uint64_t mlat; /* 12 MHz, or 0 */
+	uint8_t signal;
+	uint32_t addr;
+	uint32_t syn; /* 0xFF000000 if not yet computed */
+	size_t len;
+	uint8_t raw[14];
+};
+
+/*
+ * A bitmap of addresses, one bit for each.
+ */
+#define ADDR_FILTER_LEN (1 << 21)
+
+int buf_to_frame(const char *buf, size_t len, struct ms_frame_t *frame);
+struct ms_msg_t *buf_to_msg(const char *buf, size_t len);
 struct ms_msg_t *line_to_msg(const char *orig_line);
-struct ms_msg_t *parse_file(const char *filename, off_t *offset, struct ms_aircraft_t **);
+int read_frame(struct ms_reader_t *r, struct ms_frame_t *frame);
+uint32_t frame_addr(struct ms_frame_t *frame);
+uint8_t *mk_addr_filter();
+void add_addr_filter(uint8_t *filter, uint32_t addr);
+struct ms_msg_t *parse_reader(struct ms_reader_t *r, struct ms_ac_table_t *);
+int parse_stream(struct ms_reader_t *r, struct ms_ac_table_t *,
+                 int (*cb)(struct ms_msg_t *, void *), void *arg);
+struct ms_msg_t *parse_file(const char *filename, off_t *offset, struct ms_ac_table_t *);
 #endif
@@ -0,0 +1,641 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "reader.h"
+#include "decompress.h"
+#include "merge.h"
+
+#define READER_BUFSIZE (64 * 1024)
+#define TAILER_BUFSIZE (1024 * 1024)
+
+static int
+map_reader(struct ms_reader_t *r, off_t offset) {
+	struct stat st;
+	off_t base;
+
+	if (fstat(r->fd, &st) < 0 || !S_ISREG(st.st_mode))
+		return -1;
+
+	/*
+	 * Nothing to map, but there's no use in
+	 * falling back to reading either.
+	 */
+	if (st.st_size <= offset) {
+		r->mapped = true;
+		r->offset = offset;
+		r->buf = "";
+		return 0;
+	}
+
+	base = offset & ~((off_t)sysconf(_SC_PAGESIZE) - 1);
+
+	r->map_len = st.st_size - base;
+	r->map = mmap(NULL, r->map_len, PROT_READ, MAP_PRIVATE, r->fd, base);
+	if (r->map == MAP_FAILED) {
+		r->map = NULL;
+		return -1;
+	}
+	madvise(r->map, r->map_len, MADV_SEQUENTIAL);
+
+	r->mapped = true;
+	r->buf = r->map;
+	r->len = r->map_len;
+	r->pos = offset - base;
+	r->offset = base;
+	return 0;
+}
+
+/*
+ * Hands the input over to a decompressor, and reads its
+ * output instead, skipping offset uncompressed bytes.
+ */
+static int
+decompress_reader(struct ms_reader_t *r, enum ms_compression_t type, off_t offset) {
+	int fd = r->own_fd ? r->fd : dup(r->fd);
+
+	if (fd < 0 || !(r->dec = mk_decompressor(fd, type, (uint8_t *)r->mem, r->len))) {
+		if (fd >= 0 && !r->own_fd)
+			close(fd);
+		return -1;
+	}
+	r->fd = decompressor_fd(r->dec);
+	r->own_fd = false;
+	r->offset = 0;
+	r->pos = 0;
+	r->len = 0;
+
+	while (reader_offset(r) < offset) {
+		if (r->pos == r->len && fill_reader(r) <= 0)
+			break;
+		if ((off_t)(r->len - r->pos) < offset - reader_offset(r))
+			r->pos = r->len;
+		else
+			r->pos += offset - reader_offset(r);
+	}
+
+	return 0;
+}
+
+struct ms_reader_t *
+mk_reader(const char *filename, off_t offset) {
+	enum ms_compression_t type = COMPRESSION_NONE;
+	struct ms_reader_t *r;
+
+	r = calloc(1, sizeof(struct ms_reader_t));
+
+	if (filename) {
+		uint8_t magic[COMPRESSION_MAGIC_LEN];
+		ssize_t n;
+
+		if ((r->fd = open(filename, O_RDONLY)) < 0) {
+			free(r);
+			return NULL;
+		}
+		r->own_fd = true;
+
+		if ((n = pread(r->fd, magic, sizeof(magic), 0)) > 0)
+			type = compression_of(magic, n);
+	} else {
+		r->fd = STDIN_FILENO;
+	}
+
+	if (filename && type == COMPRESSION_NONE && map_reader(r, offset) == 0)
+		return r;
+
+	r->size = READER_BUFSIZE;
+	r->mem = malloc(r->size);
+	r->buf = r->mem;
+
+	if (type != COMPRESSION_NONE) {
+		if (decompress_reader(r, type, offset) < 0) {
+			destroy_reader(r);
+			return NULL;
+		}
+		return r;
+	}
+
+	if (offset && lseek(r->fd, offset, SEEK_SET) == -1) {
+		destroy_reader(r);
+		return NULL;
+	}
+	r->offset = offset;
+
+	/*
+	 * Piped input has to be read to be told.
+	 */
+	if (!filename) {
+		while (r->len < COMPRESSION_MAGIC_LEN && fill_reader(r) > 0)
+			;
+		type = compression_of((uint8_t *)r->mem, r->len);
+		if (type != COMPRESSION_NONE && decompress_reader(r, type, 0) < 0) {
+			destroy_reader(r);
+			return NULL;
+		}
+	}
+
+	return r;
+}
+
+/*
+ * Discard consumed bytes and read some more.
+ */
+ssize_t
+fill_reader(struct ms_reader_t *r) {
+	ssize_t bytes;
+
+	if (r->mapped || r->eof)
+		return 0;
+
+	if (r->pos) {
+		memmove(r->mem, r->mem + r->pos, r->len - r->pos);
+		r->offset += r->pos;
+		r->len -= r->pos;
+		r->pos = 0;
+	}
+
+	if (r->len == r->size) {
+		r->size *= 2;
+		r->mem = realloc(r->mem, r->size);
+		r->buf = r->mem;
+	}
+
+	if (r->fd < 0)
+		return 0;
+
+	do {
+		bytes = read(r->fd, r->mem + r->len, r->size - r->len);
+	} while (bytes < 0 && errno == EINTR);
+
+	if (r->sock && bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		return 0;
+
+	if (r->sock && bytes <= 0) {
+		/*
+		 * A listener waits for the next client, whether
+		 * the last one hung up or failed, e.g. reset the
+		 * connection, and drops what's left of its line.
+		 */
+		if (r->lfd >= 0) {
+			close(r->fd);
+			r->fd = -1;
+			r->own_fd = false;
+			r->offset += r->len;
+			r->len = 0;
+			return 0;
+		}
+		if (bytes == 0)
+			r->follow = false;
+	}
+
+	if (bytes <= 0) {
+		/*
+		 * A followed file has merely been read
+		 * up to what's been written so far.
+		 */
+		if (!(bytes == 0 && r->follow))
+			r->eof = true;
+		return bytes;
+	}
+
+	r->len += bytes;
+	return bytes;
+}
+
+/*
+ * Points line at the next line of input, which is
+ * neither copied nor terminated, and returns its
+ * length without the newline, or -1 at end of input.
+ */
+ssize_t
+read_line(struct ms_reader_t *r, const char **line) {
+	for (;;) {
+		const char *s = r->buf + r->pos;
+		size_t n = r->len - r->pos;
+		const char *nl;
+
+		if ((nl = memchr(s, '\n', n))) {
+			r->pos += nl - s + 1;
+			*line = s;
+			return nl - s;
+		}
+
+		if (fill_reader(r) <= 0) {
+			if (!n || (r->follow && !r->eof))
+				return -1;
+			/* Unterminated last line */
+			r->pos += n;
+			*line = s;
+			return n;
+		}
+	}
+}
+
+/*
+ * Drop the pages of a mapping that have been read, so that
+ * they don't add up when streaming through large files.
+ */
+void
+discard_read(struct ms_reader_t *r) {
+	size_t len;
+
+	if (r->merge)
+		discard_merged(r->merge);
+	if (!r->map)
+		return;
+
+	len = r->pos & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+	if (len)
+		madvise(r->map, len, MADV_DONTNEED);
+}
+
+off_t
+reader_offset(const struct ms_reader_t *r) {
+	return r->offset + r->pos;
+}
+
+static int
+watch_file(struct ms_reader_t *r) {
+	if (r->wd >= 0)
+		inotify_rm_watch(r->ifd, r->wd);
+	r->wd = inotify_add_watch(r->ifd, r->filename, IN_MODIFY
+	                                             | IN_ATTRIB
+	                                             | IN_DELETE_SELF
+	                                             | IN_MOVE_SELF);
+	return r->wd;
+}
+
+static int
+watch_dir(struct ms_reader_t *r) {
+	char *dir = strdup(r->filename);
+	char *slash = strrchr(dir, '/');
+
+	if (!slash)
+		strcpy(dir, ".");
+	else if (slash == dir)
+		slash[1] = '\0';
+	else
+		*slash = '\0';
+
+	r->dwd = inotify_add_watch(r->ifd, dir, IN_CREATE | IN_MOVED_TO);
+	free(dir);
+	return r->dwd;
+}
+
+static int
+open_tailer(struct ms_reader_t *r, off_t offset) {
+	int fd;
+
+	if ((fd = open(r->filename, O_RDONLY)) < 0)
+		return -1;
+	if (offset && lseek(fd, offset, SEEK_SET) == -1) {
+		close(fd);
+		return -1;
+	}
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	if (r->own_fd)
+		close(r->fd);
+	r->fd = fd;
+	r->own_fd = true;
+	r->offset = offset;
+	r->pos = 0;
+	r->len = 0;
+	r->eof = false;
+
+	return 0;
+}
+
+/*
+ * A reader that keeps its file open and reads what's
+ * appended to it, in large blocks, as it's written.
+ */
+struct ms_reader_t *
+mk_tailer(const char *filename, off_t offset) {
+	struct ms_reader_t *r;
+
+	r = calloc(1, sizeof(struct ms_reader_t));
+	r->follow = true;
+	r->filename = strdup(filename);
+	r->wd = -1;
+	r->dwd = -1;
+	r->size = TAILER_BUFSIZE;
+	r->mem = malloc(r->size);
+	r->buf = r->mem;
+
+	if ((r->ifd = inotify_init1(IN_CLOEXEC)) < 0) {
+		destroy_reader(r);
+		return NULL;
+	}
+
+	if (open_tailer(r, offset) < 0 || watch_file(r) < 0 || watch_dir(r) < 0) {
+		destroy_reader(r);
+		return NULL;
+	}
+
+	return r;
+}
+
+/*
+ * A path, for Unix domain sockets, or [host:]port for TCP,
+ * on the loopback interface unless another host is given.
+ */
+static int
+open_socket(const char *addr, bool listening) {
+	struct addrinfo hints;
+	struct addrinfo *res;
+	struct addrinfo *ai;
+	const char *port;
+	char *host;
+	int fd = -1;
+	int err;
+
+	if (strchr(addr, '/')) {
+		struct sockaddr_un sun;
+		struct stat st;
+
+		if (strlen(addr) >= sizeof(sun.sun_path)) {
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		memset(&sun, 0, sizeof(sun));
+		sun.sun_family = AF_UNIX;
+		strcpy(sun.sun_path, addr);
+
+		if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+			return -1;
+
+		if (listening) {
+			if (stat(addr, &st) == 0 && S_ISSOCK(st.st_mode))
+				unlink(addr);
+			err = bind(fd, (struct sockaddr *)&sun, sizeof(sun)) < 0
+			   || listen(fd, 1) < 0;
+		} else {
+			err = connect(fd, (struct sockaddr *)&sun, sizeof(sun)) < 0;
+		}
+		if (err) {
+			close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	host = strdup(addr);
+	if ((port = strrchr(host, ':'))) {
+		host[port - host] = '\0';
+		port += 1;
+	} else {
+		port = addr;
+		*host = '\0';
+	}
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	if ((err = getaddrinfo(*host ? host : "127.0.0.1", port, &hints, &res))) {
+		free(host);
+		errno = err == EAI_SYSTEM ? errno : EINVAL;
+		return -1;
+	}
+	free(host);
+
+	for (ai = res; ai; ai = ai->ai_next) {
+		int one = 1;
+
+		if ((fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)) < 0)
+			continue;
+		if (listening) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 1) == 0)
+				break;
+		} else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+		err = errno;
+		close(fd);
+		errno = err;
+		fd = -1;
+	}
+	freeaddrinfo(res);
+
+	return fd;
+}
+
+/*
+ * A reader of a socket that's connected to addr, or
+ * that listens on it, e.g. for rtl-modes or dump1090.
+ */
+struct ms_reader_t *
+mk_sock_reader(const char *addr, bool listening) {
+	struct ms_reader_t *r;
+	int fd;
+
+	if ((fd = open_socket(addr, listening)) < 0)
+		return NULL;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	r = calloc(1, sizeof(struct ms_reader_t));
+	r->follow = true;
+	r->sock = true;
+	r->ifd = -1;
+	r->wd = -1;
+	r->dwd = -1;
+	r->size = READER_BUFSIZE;
+	r->mem = malloc(r->size);
+	r->buf = r->mem;
+
+	if (listening) {
+		r->lfd = fd;
+		r->fd = -1;
+		if (strchr(addr, '/'))
+			r->filename = strdup(addr);
+	} else {
+		r->lfd = -1;
+		r->fd = fd;
+		r->own_fd = true;
+	}
+
+	return r;
+}
+
+static int
+accept_client(struct ms_reader_t *r) {
+	int fd;
+
+	if (r->lfd < 0 || r->fd >= 0)
+		return 0;
+
+	if ((fd = accept(r->lfd, NULL, NULL)) < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK
+		 || errno == EINTR || errno == ECONNABORTED)
+			return 0;
+		return -1;
+	}
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	r->fd = fd;
+	r->own_fd = true;
+	r->eof = false;
+	return 1;
+}
+
+/*
+ * The file descriptor to poll for r to have more to read.
+ */
+int
+reader_pollfd(const struct ms_reader_t *r) {
+	if (r->sock)
+		return r->fd >= 0 ? r->fd : r->lfd;
+	if (r->follow)
+		return r->ifd;
+	return r->fd;
+}
+
+/*
+ * To be called when a tailer has been read up to what's
+ * been written. Reopens the file if it has been replaced,
+ * after finishing the old one, and starts over if it has
+ * been truncated. Returns 1 if there's more to read,
+ * 0 if there's nothing to do but wait, and -1 on error.
+ */
+int
+follow_reader(struct ms_reader_t *r) {
+	struct stat fst;
+	struct stat st;
+
+	if (!r->follow)
+		return 0;
+	if (r->sock)
+		return accept_client(r);
+
+	if (fstat(r->fd, &fst) < 0)
+		return -1;
+
+	if (fst.st_size < r->offset + (off_t)r->len) {
+		if (lseek(r->fd, 0, SEEK_SET) == -1)
+			return -1;
+		r->offset = 0;
+		r->pos = 0;
+		r->len = 0;
+		r->eof = false;
+		return 1;
+	}
+
+	/*
+	 * Not rotated, or the new file isn't there yet.
+	 */
+	if (stat(r->filename, &st) < 0
+	 || (st.st_dev == fst.st_dev && st.st_ino == fst.st_ino))
+		return 0;
+
+	if (fill_reader(r) > 0)
+		return 1;
+
+	/*
+	 * Let an unterminated last line of the
+	 * old file be read, before moving on.
+	 */
+	if (r->pos < r->len && !r->eof) {
+		r->eof = true;
+		return 1;
+	}
+
+	if (open_tailer(r, 0) < 0)
+		return 0;
+	watch_file(r);
+
+	return 1;
+}
+
+/*
+ * Blocks until something happens to the file or its
+ * directory, or the socket. Returns -1 on error.
+ */
+int
+wait_reader(struct ms_reader_t *r) {
+	char ib[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+	ssize_t len;
+
+	if (!r->follow)
+		return -1;
+
+	if (r->sock) {
+		struct pollfd pfd;
+
+		pfd.fd = reader_pollfd(r);
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, -1) < 0 && errno != EINTR)
+			return -1;
+		return 0;
+	}
+
+	len = read(r->ifd, ib, sizeof(ib));
+
+	if (len < 0 && errno != EINTR && errno != EAGAIN)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Returns -1, with errno set to EIO, if compressed input
+ * turned out to be corrupt or truncated, so that what was
+ * read of it shouldn't be taken for all of it.
+ */
+int
+destroy_reader(struct ms_reader_t *r) {
+	int ret = 0;
+
+	if (r->dec && destroy_decompressor(r->dec) < 0)
+		ret = -1;
+	if (r->merge && destroy_merge(r->merge) < 0)
+		ret = -1;
+	if (r->sock && r->lfd >= 0) {
+		close(r->lfd);
+		if (r->filename)
+			unlink(r->filename);
+	}
+	if (r->follow && !r->sock && r->ifd >= 0)
+		close(r->ifd);
+	free(r->filename);
+	if (r->map)
+		munmap(r->map, r->map_len);
+	if (r->mem)
+		free(r->mem);
+	if (r->own_fd)
+		close(r->fd);
+	free(r);
+
+	if (ret < 0)
+		errno = EIO;
+	return ret;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2016 Lars Lindqvist <lars.lindqvist at yandex.ru>
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MS_READER_H
+#define _MS_READER_H
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+struct ms_decompressor_t;
+struct ms_merge_t;
+struct ms_dedup_t;
+
+enum ms_format_t {
+	FORMAT_AUTO,
+	FORMAT_TEXT,
+	FORMAT_BEAST,
+	FORMAT_ARCHIVE,
+	FORMAT_MERGED
+};
+
+/*
+ * Input is viewed through a window of bytes, buf[pos, len).
+ * Regular files are mapped in their entirety, so the window
+ * covers the whole file and never needs refilling. Pipes,
+ * terminals and files that can't be mapped are read in
+ * blocks into mem, which is then used as the window.
+ */
+struct ms_reader_t {
+	int fd;
+	bool own_fd;
+	bool mapped;
+	bool eof;
+
+	const char *buf;
+	size_t len;
+	size_t pos;
+	off_t offset; /* of buf[0] in file */
+
+	void *map;
+	size_t map_len;
+
+	char *mem;
+	size_t size;
+
+	struct ms_decompressor_t *dec;
+	struct ms_merge_t *merge;
+
+	/*
+	 * For tailers, the file and its directory are
+	 * watched, so that it can be followed as it grows
+	 * and when it's rotated or truncated.
+	 */
+	bool follow;
+	char *filename;
+	int ifd;
+	int wd;
+	int dwd;
+
+	/*
+	 * Sockets are read without blocking, and followed
+	 * until the other end closes. A listening reader
+	 * takes one client at a time, from lfd.
+	 */
+	bool sock;
+	int lfd;
+
+	enum ms_format_t format;
+	size_t threads; /* for parse_reader */
+	size_t batch;   /* for parse_stream, bytes */
+	off_t end;      /* of input, if not 0 */
+	time_t from;    /* only messages in [from, to), */
+	time_t to;      /* or from on if to is 0 */
+	const uint8_t *addrs; /* only these, if not NULL */
+	struct ms_dedup_t *dedup; /* drops duplicates, if not NULL */
+	bool untracked; /* aircrafts are only counted, see count_aircraft */
+
+	/*
+	 * Wall clock time of the first MLAT timestamp
+	 * seen, for inputs that have no other time.
+	 */
+	uint64_t mlat_base;
+	time_t time_base;
+};
+
+struct ms_reader_t *mk_reader(const char *filename, off_t offset);
+struct ms_reader_t *mk_tailer(const char *filename, off_t offset);
+struct ms_reader_t *mk_sock_reader(const char *addr, bool listening);
+int reader_pollfd(const struct ms_reader_t *r);
+int follow_reader(struct ms_reader_t *r);
+int wait_reader(struct ms_reader_t *r);
+ssize_t fill_reader(struct ms_reader_t *r);
+ssize_t read_line(struct ms_reader_t *r, const char **line);
+void discard_read(struct ms_reader_t *r);
+off_t reader_offset(const struct ms_reader_t *r);
+int destroy_reader(struct ms_reader_t *r);
+
+#endif
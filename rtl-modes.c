@@ -114,6 +114,19 @@ struct mag_buf {
 	uint32_t dropped;	/*  Number of dropped samples preceding this buffer */
 };
 
+/*
+ * A candidate message's parity, checked by scoreModesMessage,
+ * and used again by decode_message if it's the best one.
+ */
+struct modes_cand {
+	uint8_t msgtype;
+	size_t len;
+	uint32_t syn;		/*  Of the message as demodulated */
+	int errs;		/*  Bits in error, -1 if they can't be corrected */
+	int bits[2];		/*  Which ones */
+	uint32_t addr;		/*  Corrected AA, or AP */
+};
+
 static struct {			/*  Internal state */
 	pthread_t reader_thread;
 
@@ -154,8 +167,8 @@ static struct {
  * where t1 and t2 are 12MHz counters.
  */
 static void normalize_timespec(struct timespec *ts);
-static int scoreModesMessage(const uint8_t *msg, size_t valid_len);
-static ssize_t decode_message(const uint8_t *msg);
+static int scoreModesMessage(const uint8_t *msg, size_t valid_len, struct modes_cand *cand);
+static ssize_t decode_message(const uint8_t *msg, const struct modes_cand *cand);
 static void demodulate2400(struct mag_buf *mag);
 
 static void
@@ -273,15 +286,18 @@ slice_phase4(uint16_t * m) {
 static void
 demodulate2400(struct mag_buf *mag) {
 	uint8_t msg1[MODES_LONG_MSG_BYTES], msg2[MODES_LONG_MSG_BYTES], *msg;
+	struct modes_cand cand1, cand2, *cand;
 	uint32_t j;
 
 	uint8_t *bestmsg;
+	struct modes_cand *bestcand;
 	int bestscore;
 
 	uint16_t *m = mag->data;
 	uint32_t mlen = mag->length;
 
 	msg = msg1;
+	cand = &cand1;
 
 	for (j = 0; j < mlen; j++) {
 		uint16_t *preamble = &m[j];
@@ -367,6 +383,7 @@ demodulate2400(struct mag_buf *mag) {
 		 * Try all phases
 		 */
 		bestmsg = NULL;
+		bestcand = NULL;
 		bestscore = -2;
 		for (try_phase = 4; try_phase <= 8; ++try_phase) {
 			uint16_t *pPtr;
@@ -489,9 +506,10 @@ demodulate2400(struct mag_buf *mag) {
 			/*
 			 * Score the mode S message and see if it's any good.
 			 */
-			score = scoreModesMessage(msg, i);
+			score = scoreModesMessage(msg, i, cand);
 			if (score > bestscore) {
 				bestmsg = msg;
+				bestcand = cand;
 				bestscore = score;
 				/*
 				 * Swap to using the other buffer so we don't clobber our demodulated data
@@ -499,6 +517,7 @@ demodulate2400(struct mag_buf *mag) {
 				 * we no longer need this copy if we found a better one)
 				 */
 				msg = (msg == msg1) ? msg2 : msg1;
+				cand = (cand == &cand1) ? &cand2 : &cand1;
 			}
 		}
 
@@ -507,7 +526,7 @@ demodulate2400(struct mag_buf *mag) {
 			continue;
 		}
 
-		msglen = decode_message(bestmsg);
+		msglen = decode_message(bestmsg, bestcand);
 		if (msglen <= 0) {
 			continue;
 		}
@@ -860,12 +879,14 @@ readerThreadEntryPoint(void *arg) {
  *   -2: bad message or unrepairable CRC error
  */
 static int
-scoreModesMessage(const uint8_t *msg, size_t valid_len) {
+scoreModesMessage(const uint8_t *msg, size_t valid_len, struct modes_cand *cand) {
 	uint8_t msgtype;
 	uint32_t addr;
 	uint32_t syn;
+	uint32_t mask = 0xFFFFFF;
 	size_t len;
-	bool errs;
+	int errs;
+	int i;
 	struct {
 		int old;
 		int new;
@@ -880,6 +901,12 @@ scoreModesMessage(const uint8_t *msg, size_t valid_len) {
 
 	syn = crc_syndrome(msg, len);
 
+	cand->msgtype = msgtype;
+	cand->len = len;
+	cand->syn = syn;
+	cand->errs = 0;
+	cand->addr = syn;
+
 	switch (msgtype) {
 	case 0:
 	case 4:
@@ -915,7 +942,7 @@ scoreModesMessage(const uint8_t *msg, size_t valid_len) {
 		if (syn & 0x7F) {
 			scores.old = 1000;
 			scores.new = -100;
-			syn &= 0xffff80;
+			mask = CRC_IID_MASK;
 		} else {
 			scores.old = 1600;
 			scores.new =  750;
@@ -925,47 +952,51 @@ scoreModesMessage(const uint8_t *msg, size_t valid_len) {
 		return -2;
 	}
 
-	errs = syn != 0x000000;
 	addr = (msg[1] << 16) | (msg[2] << 8) | (msg[3]);
 
-	if (errs) {
-		int eb = errorbit(len, syn);
-		if (eb == -1)
-			return -2;
-		if (7 < eb && eb < 32) {
-			addr ^= (1 << (31 - eb));
+	if ((errs = crc_error_bits(len, syn, mask, Modes.nfix_crc, cand->bits)) < 0) {
+		cand->errs = -1;
+		return -2;
+	}
+	for (i = 0; i < errs; ++i) {
+		if (7 < cand->bits[i] && cand->bits[i] < 32) {
+			addr ^= (1 << (31 - cand->bits[i]));
 		}
 	}
+	cand->errs = errs;
+	cand->addr = addr;
+
+	/*
+	 * Halved for each bit fixed.
+	 */
 	if (icao_cache_seen(addr))
-		return scores.old / (errs ? 2 : 1);
+		return scores.old / (1 << errs);
 	else
-		return scores.new / (errs ? 2 : 1);
+		return scores.new / (1 << errs);
 }
 
 /*
  * return length of message, in bits, if all OK
  *   -1: message might be valid, but we couldn't validate the CRC against a known ICAO
  *   -2: bad message or unrepairable CRC error
+ *
+ * The message is written with the syndrome it has once
+ * corrected, so that readers needn't compute it again.
  */
 static ssize_t
-decode_message(const uint8_t *orig_msg) {
+decode_message(const uint8_t *orig_msg, const struct modes_cand *cand) {
 	uint8_t msg[MODES_LONG_MSG_BYTES];
-	uint8_t msgtype;
+	uint8_t msgtype = cand->msgtype;
 	uint32_t addr;
-	uint32_t syn;
-	size_t len;
+	uint32_t syn = cand->syn;
+	size_t len = cand->len;
 	size_t i;
 	bool msg_has_addr;
 
 
-	msgtype = get_msgtype(orig_msg[0]);
-	len = df_to_len(msgtype);
-
 	/*  Work on our local copy. */
 	memcpy(msg, orig_msg, len);
 
-	syn = crc_syndrome(msg, len);
-
 	/*  Do checksum work and set fields that depend on the CRC */
 	switch (msgtype) {
 	case 0:
@@ -982,9 +1013,6 @@ decode_message(const uint8_t *orig_msg) {
 		msg_has_addr = false;
 		break;
 	case 11:
-		syn &= 0xFFFF80;
-		msg_has_addr = true;
-		break;
 	case 17:
 		msg_has_addr = true;
 		break;
@@ -1001,18 +1029,16 @@ decode_message(const uint8_t *orig_msg) {
 
 
 	if (msg_has_addr) {
-		if (syn == 0x000000) {
-			addr = (msg[1] << 16) | (msg[2] << 8) | (msg[3]);
+		if (cand->errs < 0) {
+			return -2;
+		}
+		for (i = 0; i < (size_t)cand->errs; ++i) {
+			msg[cand->bits[i] / 8] ^= (1 << (7 - (cand->bits[i] % 8)));
+		}
+		syn = crc_fixed_syndrome(len, syn, cand->bits, cand->errs);
+		addr = cand->addr;
+		if (!cand->errs) {
 			icao_cache_add(addr);
-		} else {
-			int eb = errorbit(len, syn);
-			
-			if (eb < 5) {
-				return -2;
-			}
-
-			msg[eb / 8] ^= (1 << (7 - (eb % 8)));
-			addr = (msg[1] << 16) | (msg[2] << 8) | (msg[3]);
 		}
 	} else {
 		addr = syn;
@@ -1026,7 +1052,7 @@ decode_message(const uint8_t *orig_msg) {
 	for (i = 0; i < len; ++i) {
 		fprintf(msout.fp, "%02X", msg[i]);
 	}
-	fprintf(msout.fp, ":%06X\n", addr);
+	fprintf(msout.fp, ":%06X:%06X\n", addr, syn);
 	fflush(msout.fp);
 	
 	return len * 8;
@@ -1109,8 +1135,8 @@ daemonize() {
 
 static void
 usage() {
-	printf("usage: %s [-D device index]\n", argv0);
-	printf("usage: %s -d [-f logfile] [-o outfile] [-u uid] [-g gid] [-D device index]\n", argv0);
+	printf("usage: %s [-e bits] [-D device index]\n", argv0);
+	printf("usage: %s -d [-f logfile] [-o outfile] [-u uid] [-g gid] [-e bits] [-D device index]\n", argv0);
 	exit(1);
 }
 
@@ -1119,6 +1145,7 @@ main(int argc, char **argv) {
 	memset(&Modes, 0, sizeof(Modes));
 	memset(&icao_cache, 0, sizeof(icao_cache));
 	Modes.check_crc = 1;
+	Modes.nfix_crc = default_nfix_crc;
 	Modes.fd = -1;
 
 	memset(&msd,   0, sizeof(msd));
@@ -1155,6 +1182,11 @@ main(int argc, char **argv) {
 	case 'u':
 		msd.uid = atoi(EARGF(usage()));
 		break;
+	case 'e':
+		Modes.nfix_crc = atoi(EARGF(usage()));
+		if (Modes.nfix_crc < 0 || Modes.nfix_crc > 2)
+			usage();
+		break;
 	default:
 		usage();
 	} ARGEND;
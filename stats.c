@@ -51,6 +51,14 @@ ac_cmp(const void *a, const void *b) {
 	return ((const struct ac_stats_t *)b)->n_msgs - ((const struct ac_stats_t *)a)->n_msgs;
 }
 
+static int
+ac_addr_cmp(const void *a, const void *b) {
+	uint32_t x = ((const struct ac_stats_t *)a)->addr;
+	uint32_t y = ((const struct ac_stats_t *)b)->addr;
+
+	return (x > y) - (x < y);
+}
+
 static int
 nat_cmp(const void *a, const void *b) {
 	return ((const struct nat_stats_t *)b)->n_msgs - ((const struct nat_stats_t *)a)->n_msgs;
@@ -214,25 +222,80 @@ update_stats(struct ms_stats_t *stats, const struct ms_msg_t *msgs) {
 	}
 }
 
+static void
+set_ac_stats(struct ac_stats_t *s, const struct ms_aircraft_t *a) {
+	s->addr = a->addr;
+	memcpy(s->name, a->name, sizeof(s->name));
+	s->iso3 = a->nation->iso3;
+	s->n_msgs = a->n_messages;
+}
+
+/*
+ * An aircraft retired before the end is kept in mbya,
+ * to be counted with the rest by finalise_stats.
+ */
+int
+retire_stats(struct ms_stats_t *stats, const struct ms_aircraft_t *a) {
+	if (stats->n_acs == stats->max_acs) {
+		size_t max = stats->max_acs ? 2 * stats->max_acs : 256;
+		struct ac_stats_t *tmp;
+
+		tmp = realloc(stats->mbya, max * sizeof(struct ac_stats_t));
+		if (!tmp)
+			return -1;
+		stats->mbya = tmp;
+		stats->max_acs = max;
+	}
+	set_ac_stats(&stats->mbya[stats->n_acs++], a);
+	return 0;
+}
+
+/*
+ * The aircrafts left are added to those retired, and an
+ * aircraft seen more than once is counted once, with the
+ * messages of all its stays.
+ */
 void
 finalise_stats(struct ms_stats_t *stats, const struct ms_aircraft_t *aircrafts) {
 	const struct ms_aircraft_t *a;
-	size_t i;
+	struct ac_stats_t *tmp;
+	size_t n = stats->n_acs;
+	size_t i, j;
 
 	for (a = aircrafts; a; a = a->next) {
-		stats->n_acs++;
+		n++;
 	}
-	
-	stats->mbya = malloc(stats->n_acs * sizeof(struct ac_stats_t));
+
+	tmp = realloc(stats->mbya, (n ? n : 1) * sizeof(struct ac_stats_t));
+	if (!tmp) {
+		/* Only the aircrafts retired are counted */
+		n = stats->n_acs;
+	} else {
+		stats->mbya = tmp;
+		stats->max_acs = n;
+		for (a = aircrafts; a; a = a->next)
+			set_ac_stats(&stats->mbya[stats->n_acs++], a);
+	}
+
+	qsort(stats->mbya, n, sizeof(struct ac_stats_t), ac_addr_cmp);
+	for (i = 0, j = 0; j < n; ++j) {
+		if (i && stats->mbya[i - 1].addr == stats->mbya[j].addr) {
+			stats->mbya[i - 1].n_msgs += stats->mbya[j].n_msgs;
+			if (stats->mbya[j].name[0])
+				memcpy(stats->mbya[i - 1].name, stats->mbya[j].name,
+				       sizeof(stats->mbya[j].name));
+		} else {
+			stats->mbya[i++] = stats->mbya[j];
+		}
+	}
+	stats->n_acs = i;
+
 	stats->mbyn = calloc(stats->n_acs,  sizeof(struct nat_stats_t));
 	stats->abyn = calloc(stats->n_acs,  sizeof(struct nat_stats_t));
 
-	for (i = 0, a = aircrafts; a && i < stats->n_acs; ++i, a = a->next) {
-		stats->mbya[i].addr = a->addr;
-		stats->mbya[i].name = a->name;
-		stats->mbya[i].iso3 = a->nation->iso3;
-		stats->mbya[i].n_msgs = a->n_messages;
-		stats->n_nats += update_nat(stats->mbyn, a->nation->iso3, a->n_messages, stats->n_nats);
+	for (i = 0; i < stats->n_acs; ++i) {
+		stats->n_nats += update_nat(stats->mbyn, stats->mbya[i].iso3,
+		                            stats->mbya[i].n_msgs, stats->n_nats);
 	}
 
 	memcpy(stats->abyn, stats->mbyn, sizeof(struct nat_stats_t) * stats->n_acs);
@@ -279,10 +342,7 @@ init_stats(struct ms_stats_t *stats, const struct ms_aircraft_t *aircrafts) {
 	stats->abyn = calloc(stats->n_acs,  sizeof(struct nat_stats_t));
 
 	for (i = 0, a = aircrafts; a && i < stats->n_acs; ++i, a = a->next) {
-		stats->mbya[i].addr = a->addr;
-		stats->mbya[i].name = a->name;
-		stats->mbya[i].iso3 = a->nation->iso3;
-		stats->mbya[i].n_msgs = a->n_messages;
+		set_ac_stats(&stats->mbya[i], a);
 		stats->n_nats += update_nat(stats->mbyn, a->nation->iso3, a->n_messages, stats->n_nats);
 	}
 
@@ -325,6 +385,10 @@ pr_stats(const struct ms_stats_t *s) {
 	printf("───────────────┼───────────────┬───────────────┤\n");
 	printf(" Messages      │ Aircrafts     │ Nations       │\n");
 	printf(" %'13lu │ %'13lu │ %'13lu │\n", s->n_msgs, s->n_acs, s->n_nats);
+	if (s->n_dups) {
+		printf("───────────────┼───────────────┼───────────────┤\n");
+		printf(" Duplicates    │ %'13lu │               │\n", s->n_dups);
+	}
 	printf("───────────────┴───────────────┴───────────────┘\n");
 
 	puts("");
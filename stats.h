@@ -3,7 +3,7 @@
 
 struct ac_stats_t {
 	uint32_t addr;
-	const char *name;
+	char name[9];
 	const char *iso3;
 	size_t n_msgs;
 };
@@ -16,6 +16,7 @@ struct nat_stats_t {
 
 struct ms_stats_t {
 	struct ac_stats_t *mbya;
+	size_t max_acs;
 	struct nat_stats_t *mbyn;
 	struct nat_stats_t *abyn;
 	time_t first;
@@ -23,6 +24,7 @@ struct ms_stats_t {
 	size_t n_msgs;
 	size_t n_acs;
 	size_t n_nats;
+	size_t n_dups;
 	size_t n_dfs[32];
 };
 	
@@ -32,6 +34,7 @@ void init_stats(struct ms_stats_t *, const struct ms_aircraft_t *);
 void cleanup_stats(struct ms_stats_t *);
 void pr_stats(const struct ms_stats_t *);
 
+int retire_stats(struct ms_stats_t *stats, const struct ms_aircraft_t *a);
 void finalise_stats(struct ms_stats_t *stats, const struct ms_aircraft_t *aircrafts);
 void update_stats(struct ms_stats_t *stats, const struct ms_msg_t *msgs);
 struct ms_stats_t *mk_stats();
@@ -62,12 +62,8 @@ decode_angle(uint8_t v) {
 	return (double)v * 360.0 / 32.0;
 }
 
-struct ms_TISB_coarse_t *
-mk_TISB_coarse(const uint8_t *msg) {
-	struct ms_TISB_coarse_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_TISB_coarse_t));
-
+void
+mk_TISB_coarse(struct ms_TISB_coarse_t *ret, const uint8_t *msg) {
 	ret->IMF = (msg[0] & 0x80);
 
 	ret->SS   = (msg[0] >> 5) & 0x03;
@@ -92,8 +88,6 @@ mk_TISB_coarse(const uint8_t *msg) {
 	ret->CPR.lat = (msg[4] << 4) | (msg[5] >> 4);
 	ret->CPR.lon = ((msg[5] & 0x0F) << 8) | msg[6];
 	ret->CPR.surface = false;
-
-	return ret;
 }
 
 static void
@@ -29,6 +29,6 @@ struct ms_TISB_coarse_t {
 	struct ms_CPR_t CPR;
 };
 
-struct ms_TISB_coarse_t *mk_TISB_coarse(const uint8_t *msg);
+void mk_TISB_coarse(struct ms_TISB_coarse_t *ret, const uint8_t *msg);
 void pr_TISB_coarse(FILE *fp, const struct ms_TISB_coarse_t *, int v);
 #endif
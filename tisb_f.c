@@ -37,12 +37,8 @@
  *
  */
 
-struct ms_TISB_fine_t *
-mk_TISB_fine(const uint8_t *msg) {
-	struct ms_TISB_fine_t *ret;
-
-	ret = calloc(1, sizeof(struct ms_TISB_fine_t));
-
+void
+mk_TISB_fine(struct ms_TISB_fine_t *ret, const uint8_t *msg) {
 	ret->FTC = msg[0] >> 3;
 	ret->IMF = msg[0] & 0x01;
 
@@ -63,7 +59,6 @@ mk_TISB_fine(const uint8_t *msg) {
 	             |   msg[6];
 
 	
-	return ret;
 }
 
 void
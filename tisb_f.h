@@ -27,6 +27,6 @@ struct ms_TISB_fine_t {
 	struct ms_CPR_t CPR;
 };
 
-struct ms_TISB_fine_t *mk_TISB_fine(const uint8_t *msg);
+void mk_TISB_fine(struct ms_TISB_fine_t *ret, const uint8_t *msg);
 void pr_TISB_fine(FILE *fp, const struct ms_TISB_fine_t *, int v);
 #endif